@@ -46,7 +46,7 @@
 /* Maximum attribute length */
 #define CY_BT_MAX_ATTR_LEN                                    512
 /* Maximum attribute MTU size */
-#define CY_BT_MTU_SIZE                                        23
+#define CY_BT_MTU_SIZE                                        247
 
 /* RX PDU size */
 #define CY_BT_RX_PDU_SIZE                                     512
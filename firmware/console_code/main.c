@@ -65,6 +65,8 @@
 #include "source/app_hw/task_ble.h" 
 #include "console.h"
 #include "i2c.h"
+#include "timestamp.h"
+#include "boot_timeline.h"
 
 int main(void)
 {
@@ -76,6 +78,11 @@ int main(void)
 
     __enable_irq();
 
+    /* Boot stages are stamped from here, read them back with "BOOT" */
+    rslt = timestamp_init();
+    CY_ASSERT(rslt == CY_RSLT_SUCCESS);
+    boot_timeline_init();
+
     /* 1. Initialize UART with explicit 115200 baud rate */
     // cy_retarget_io_init(CYBSP_DEBUG_UART_TX, CYBSP_DEBUG_UART_RX, 115200);
     // printf("[MAIN] Debug UART TX=0x%X, RX=0x%X\r\n", CYBSP_DEBUG_UART_TX, CYBSP_DEBUG_UART_RX);
@@ -91,13 +98,15 @@ int main(void)
 
     /* Commenting out other tasks to prevent blocking/crashes during BLE debug */
     // task_console_init(); // --Causing blocking issue for some reason
+
+    /* Peripherals come up in the boot graph once the scheduler runs, so
+       the BLE task starts scanning without waiting for them */
     task_ble_init();
     console_init();
 
-    
     // printf("[SYSTEM] Starting FreeRTOS Scheduler...\r\n");
-    Cy_SysLib_Delay(1000);
-     vTaskStartScheduler();
+    boot_mark("scheduler");
+    vTaskStartScheduler();
     
     /* Should never get here */
     for (;;)
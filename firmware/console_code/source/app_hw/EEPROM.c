@@ -18,11 +18,15 @@ void eeprom_write(uint8_t data, uint8_t address) {
     //Write the data to the eeprom
     uint8_t write_buffer[2] = {address, data};
 
+    xSemaphoreTake(Semaphore_I2C_Main, portMAX_DELAY);
+
     cyhal_gpio_write(EEPROM_W_PIN, 0);
 
     cyhal_i2c_master_write(&i2c_master_obj2, EEPROM_SUBORDINATE_ADDR, write_buffer, 2, 0, true);
     
     cyhal_gpio_write(EEPROM_W_PIN, 1);
+
+    xSemaphoreGive(Semaphore_I2C_Main);
 }
 
 
@@ -31,10 +35,35 @@ uint8_t eeprom_read(uint8_t address) {
 
     uint8_t receive_data = 0x00;
 
+    xSemaphoreTake(Semaphore_I2C_Main, portMAX_DELAY);
+
     cyhal_i2c_master_write(&i2c_master_obj2, EEPROM_SUBORDINATE_ADDR, &address, 1, 0, false);
 
     cyhal_i2c_master_read(&i2c_master_obj2, EEPROM_SUBORDINATE_ADDR, &receive_data, 1, 0, true);
+
+    xSemaphoreGive(Semaphore_I2C_Main);
     
     return receive_data;
 
-}
\ No newline at end of file
+}
+
+void eeprom_write_block(uint8_t address, const uint8_t *data, uint8_t len) {
+
+    /* The bus is free for the light sensor during each write cycle */
+    for (uint8_t i = 0; i < len; i++) {
+        eeprom_write(data[i], address + i);
+        vTaskDelay(pdMS_TO_TICKS(EEPROM_WRITE_CYCLE_MS));
+    }
+}
+
+
+void eeprom_read_block(uint8_t address, uint8_t *data, uint8_t len) {
+
+    xSemaphoreTake(Semaphore_I2C_Main, portMAX_DELAY);
+
+    cyhal_i2c_master_write(&i2c_master_obj2, EEPROM_SUBORDINATE_ADDR, &address, 1, 0, false);
+
+    cyhal_i2c_master_read(&i2c_master_obj2, EEPROM_SUBORDINATE_ADDR, data, len, 0, true);
+
+    xSemaphoreGive(Semaphore_I2C_Main);
+}
@@ -11,4 +11,17 @@ cy_rslt_t init_EEPROM(void);
 void eeprom_write(uint8_t data, uint8_t address);
 uint8_t eeprom_read(uint8_t address);
 
+/* Byte writes take up to EEPROM_WRITE_CYCLE_MS each, during which the chip ignores the bus */
+#define EEPROM_WRITE_CYCLE_MS   5
+
+/**
+ * @brief Write len bytes from address on, waiting out each write cycle (task context only).
+ */
+void eeprom_write_block(uint8_t address, const uint8_t *data, uint8_t len);
+
+/**
+ * @brief Read len bytes from address on in one sequential read.
+ */
+void eeprom_read_block(uint8_t address, uint8_t *data, uint8_t len);
+
 #endif
\ No newline at end of file
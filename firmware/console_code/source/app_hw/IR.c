@@ -5,6 +5,7 @@
 #include "VL53L4CD_calibration.h"
 #include "cyhal_uart.h"
 #include "uart.h"
+#include "link_policy.h"
 #include <inttypes.h>
 #include <stdint.h>
 
@@ -55,6 +56,7 @@ void sensor_poll(void)
             //Detected within the threshold -- Send uart signal to send pause screen
             // printf("Detected Movement!\r\n");
             uart_send_string("PAUSE\n");
+            link_policy_game_event(LINK_GAME_PAUSE);
             
         }
 
@@ -64,6 +66,7 @@ void sensor_poll(void)
             // printf("Result: status=%d, range_status=%d, distance=%d mm\r\n", 
             //    status, results.range_status, results.distance_mm);
                uart_send_string("UNPAUSE\n");
+               link_policy_game_event(LINK_GAME_UNPAUSE);
         }
         
            
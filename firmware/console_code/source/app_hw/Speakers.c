@@ -14,11 +14,8 @@ EventGroupHandle_t wall_event = NULL;
 cy_rslt_t speakers_init() {
     cy_rslt_t result;
 
-    wall_event = xEventGroupCreate();
-    if (wall_event == NULL) {
-        return CY_RSLT_TYPE_ERROR;  // Failed to create event group
-    }
-    
+    /* wall_event is created by console_init(); the startup chime is played
+       by Speaker_task on BOOT_CHIME_EVENT_BIT instead of blocking here */
     result = cyhal_dac_init(&dac_obj, SPEAKER_PIN);
 
     if (CY_RSLT_SUCCESS != result)
@@ -29,9 +26,6 @@ cy_rslt_t speakers_init() {
 
     cyhal_dac_write(&dac_obj, 32768);
 
-    speaker_startup(speaker_buffer, 256, 16800);
-    speaker_mario_coin(speaker_buffer, 256, AUDIO_SAMPLE_RATE_HZ);
-
     // beep(speaker_buffer, 256, 230000, 680);
     // beep(speaker_buffer, 256, 400000, 980);
     // speaker_victory(speaker_buffer, 256, AUDIO_SAMPLE_RATE_HZ);
@@ -13,6 +13,7 @@ extern EventGroupHandle_t wall_event;
 #define WALL_EVENT_BIT (1<<1)
 #define VICTORY_EVENT_BIT (1<<2) 
 #define CONNECTION_EVENT_BIT (1<<3)
+#define BOOT_CHIME_EVENT_BIT (1<<4)
 
 
 #define TEST_FREQUENCY_HZ   1000
@@ -0,0 +1,372 @@
+#include "ble_input.h"
+#include "console.h"
+#include "link_policy.h"
+#include "timestamp.h"
+
+#include <string.h>
+#include <stdio.h>
+
+/* Analog notification: [NOTIFY_TYPE_TILT, int8 roll, int8 pitch] */
+#define NOTIFY_TYPE_TILT        0xA0
+#define NOTIFY_TILT_LEN         3
+
+/* Gesture notification v2, little endian:
+ * [NOTIFY_TYPE_GESTURE, version, gesture, flags, seq lo, seq hi, timestamp_us (4)]
+ * Later versions only append fields. A 1-byte notification is the legacy
+ * form, the gesture code on its own */
+#define NOTIFY_TYPE_GESTURE     0xB0
+#define NOTIFY_VERSION_2        2
+#define NOTIFY_GESTURE_V2_LEN   10
+#define NOTIFY_FLAG_REPEAT      0x01
+#define NOTIFY_FLAG_BUTTON      0x02
+
+_Static_assert((INPUT_RING_LEN & (INPUT_RING_LEN - 1)) == 0, "INPUT_RING_LEN must be a power of two");
+_Static_assert(NOTIFY_GESTURE_V2_LEN <= INPUT_DATA_MAX, "Gesture packet does not fit a ring entry");
+
+typedef struct {
+    uint32_t arrival_us;        /* timestamp_us() in the stack callback */
+    uint8_t len;                /* 0 = new connection */
+    uint8_t data[INPUT_DATA_MAX];
+} input_entry_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Ring: the stack callback only moves ring_head, the input task only
+ * ring_tail. Both run free and wrap, used = head - tail */
+static input_entry_t input_ring[INPUT_RING_LEN];
+static volatile uint32_t ring_head = 0;
+static volatile uint32_t ring_tail = 0;
+static TaskHandle_t input_task_handle = NULL;
+
+static ble_input_stats_t input_stats;
+static uint64_t input_latency_sum_us = 0;
+
+/* Gesture packet accounting, input task only, reset on every connection */
+static ble_notify_stats_t notify_stats;
+static uint16_t notify_expected_seq = 0;
+static uint32_t notify_seen = 0;     /* Bit n: seq (notify_expected_seq - 1 - n) arrived */
+static uint32_t notify_min_offset_us = 0;
+static uint32_t notify_latency_sum_us = 0;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void input_task(void *arg);
+static bool ring_push(const uint8_t *data, uint8_t len);
+static void input_process(const input_entry_t *entry);
+static void forward_tilt(int8_t roll, int8_t pitch);
+static void forward_gesture(uint8_t gesture);
+static bool track_gesture_packet(uint16_t seq, uint32_t sent_us, uint32_t arrival_us, uint8_t flags);
+
+/*******************************************************************************
+* Function Name: ble_input_init
+*******************************************************************************/
+cy_rslt_t ble_input_init(void)
+{
+    if (xTaskCreate(input_task, "BLE Input", INPUT_TASK_STACK_SIZE, NULL, INPUT_TASK_PRIORITY,
+                    &input_task_handle) != pdPASS)
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: ble_input_notify
+*******************************************************************************/
+void ble_input_notify(const uint8_t *data, uint16_t len)
+{
+    if (data == NULL || len == 0) return;
+    if (len > INPUT_DATA_MAX)
+    {
+        input_stats.oversize++;
+        return;
+    }
+    ring_push(data, (uint8_t)len);
+}
+
+/*******************************************************************************
+* Function Name: ble_input_connected
+*******************************************************************************/
+void ble_input_connected(void)
+{
+    ring_push(NULL, 0);
+}
+
+/*******************************************************************************
+* Function Name: ring_push
+*
+* Stack callback only: copy into the next free entry, then publish it.
+*******************************************************************************/
+static bool ring_push(const uint8_t *data, uint8_t len)
+{
+    uint32_t head = ring_head;
+    uint32_t used = head - ring_tail;
+    input_entry_t *entry;
+
+    if (used >= INPUT_RING_LEN)
+    {
+        input_stats.overflow++;
+        return false;
+    }
+
+    entry = &input_ring[head & (INPUT_RING_LEN - 1)];
+    entry->arrival_us = timestamp_us();
+    entry->len = len;
+    if (len > 0) memcpy(entry->data, data, len);
+
+    /* The entry is complete before the input task can see it */
+    __DMB();
+    ring_head = head + 1;
+
+    if (len > 0) input_stats.queued++;
+    if (used + 1 > input_stats.high_water) input_stats.high_water = (uint8_t)(used + 1);
+    xTaskNotifyGive(input_task_handle);
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: input_task
+*******************************************************************************/
+static void input_task(void *arg)
+{
+    (void)arg;
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (ring_tail != ring_head)
+        {
+            /* Read the head before the entry it published */
+            __DMB();
+            input_process(&input_ring[ring_tail & (INPUT_RING_LEN - 1)]);
+
+            /* Done with the entry before the slot goes back */
+            __DMB();
+            ring_tail++;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: input_process
+*******************************************************************************/
+static void input_process(const input_entry_t *entry)
+{
+    const uint8_t *p = entry->data;
+    uint32_t latency;
+
+    if (entry->len == 0)
+    {
+        memset(&notify_stats, 0, sizeof(notify_stats));
+        notify_latency_sum_us = 0;
+        return;
+    }
+
+    /* Analog tilt sample */
+    if (entry->len == NOTIFY_TILT_LEN && p[0] == NOTIFY_TYPE_TILT)
+    {
+        if (timestamp_us() - entry->arrival_us > INPUT_TILT_STALE_US)
+        {
+            input_stats.stale++;
+            return;
+        }
+        forward_tilt((int8_t)p[1], (int8_t)p[2]);
+    }
+    /* Gesture, v2 with sequence number and timestamp */
+    else if (entry->len >= NOTIFY_GESTURE_V2_LEN && p[0] == NOTIFY_TYPE_GESTURE && p[1] >= NOTIFY_VERSION_2)
+    {
+        uint16_t seq = p[4] | (p[5] << 8);
+        uint32_t sent_us = p[6] | (p[7] << 8) | (p[8] << 16) | ((uint32_t)p[9] << 24);
+
+        /* Stamped on arrival, so the wait in the ring does not count as link latency */
+        if (track_gesture_packet(seq, sent_us, entry->arrival_us, p[3])) forward_gesture(p[2]);
+    }
+    /* Legacy 1-byte gesture, nothing to track */
+    else if (entry->len == 1)
+    {
+        notify_stats.legacy++;
+        forward_gesture(p[0]);
+    }
+    else
+    {
+        return;
+    }
+
+    latency = timestamp_us() - entry->arrival_us;
+    input_stats.processed++;
+    input_latency_sum_us += latency;
+    input_stats.latency_avg_us = (uint32_t)(input_latency_sum_us / input_stats.processed);
+    if (latency > input_stats.latency_max_us) input_stats.latency_max_us = latency;
+}
+
+/*******************************************************************************
+* Function Name: forward_tilt
+*
+* Analog frame to the Pi, "A <x> <y>\n" in degrees. Axes follow the discrete
+* mapping below: +x is RIGHT (controller pitch), +y is DOWN (controller roll).
+* Unchanged samples are not resent.
+*******************************************************************************/
+static void forward_tilt(int8_t roll, int8_t pitch)
+{
+    static int8_t last_roll = 0;
+    static int8_t last_pitch = 0;
+    static bool sent = false;
+    char msg[16];
+
+    if (sent && roll == last_roll && pitch == last_pitch) return;
+    last_roll = roll;
+    last_pitch = pitch;
+    sent = true;
+
+    snprintf(msg, sizeof(msg), "A %d %d\n", pitch, roll);
+    uart_send_string(msg);
+}
+
+/*******************************************************************************
+* Function Name: track_gesture_packet
+*
+* Sequence accounting for v2 gesture packets. The two clocks are not synced,
+* so latency is relative: (arrival - controller timestamp) minus the smallest
+* such offset seen this connection, i.e. how much later than the fastest
+* packet this one arrived. Clock drift (tens of ppm) is ignored.
+* Returns false for a duplicate, which must not move the player again. The
+* last 32 sequence numbers are remembered, so a repeat is caught even after
+* newer packets; anything older than that is treated as a repeat too.
+*******************************************************************************/
+static bool track_gesture_packet(uint16_t seq, uint32_t sent_us, uint32_t arrival_us, uint8_t flags)
+{
+    uint32_t offset = arrival_us - sent_us;
+    uint32_t latency;
+    int16_t gap;
+    uint16_t age;
+
+    notify_stats.button = (flags & NOTIFY_FLAG_BUTTON) ? 1 : 0;
+
+    if (notify_stats.received == 0)
+    {
+        notify_min_offset_us = offset;
+        notify_seen = 1;
+        notify_expected_seq = seq + 1;
+    }
+    else
+    {
+        gap = (int16_t)(seq - notify_expected_seq);
+        if (gap >= 0)
+        {
+            notify_stats.lost += gap;
+            notify_seen = (gap >= 31) ? 1 : (notify_seen << (gap + 1)) | 1;
+            notify_expected_seq = seq + 1;
+        }
+        else
+        {
+            age = (uint16_t)(-gap - 1);
+            if (age >= 32 || (notify_seen & (1UL << age)))
+            {
+                notify_stats.duplicates++;
+                return false;
+            }
+            /* Counted as lost when it was skipped, it turned up after all */
+            notify_seen |= 1UL << age;
+            notify_stats.reordered++;
+            if (notify_stats.lost > 0) notify_stats.lost--;
+        }
+    }
+
+    notify_stats.received++;
+
+    if ((int32_t)(offset - notify_min_offset_us) < 0)
+    {
+        notify_min_offset_us = offset;
+    }
+    latency = offset - notify_min_offset_us;
+    notify_latency_sum_us += latency;
+    notify_stats.latency_avg_us = notify_latency_sum_us / notify_stats.received;
+    if (latency > notify_stats.latency_max_us) notify_stats.latency_max_us = latency;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: forward_gesture
+*******************************************************************************/
+static void forward_gesture(uint8_t gesture)
+{
+    static uint8_t left_count = 0;
+    static uint8_t right_count = 0;
+    static uint8_t up_count = 0;
+    static uint8_t down_count = 0;
+    int MOVE_THRESHOLD = 1;
+
+    if (gesture != 0x00) link_policy_gesture();
+
+    switch (gesture)
+    {
+        case 0x01:  
+        left_count++;
+        if (left_count >= MOVE_THRESHOLD) {
+            uart_send_string("LEFT\n");
+            // printf("Move: LEFT\r\n");
+            left_count = 0;
+        }
+        right_count = 0;
+        up_count = 0;
+        down_count = 0;
+        break;
+        case 0x02:
+        right_count++;
+        if (right_count >= MOVE_THRESHOLD) {
+            // printf("Move: RIGHT\r\n"); 
+            uart_send_string("RIGHT\n");
+            right_count = 0;
+        }
+        left_count = 0;
+        up_count = 0;
+        down_count = 0;
+        break;
+        case 0x03: 
+        up_count++;
+        if (up_count >= MOVE_THRESHOLD) {
+            // printf("Move: UP\r\n"); 
+            uart_send_string("UP\n");
+            up_count = 0;
+        }
+        left_count = 0;
+        right_count = 0;
+        down_count = 0;
+        break;
+        case 0x04: 
+        down_count++;
+        if (down_count >= MOVE_THRESHOLD) {
+            // printf("Move: DOWN\r\n");
+            uart_send_string("DOWN\n"); 
+            down_count = 0;
+        }
+        left_count = 0;
+        right_count = 0;
+        up_count = 0;
+        break;
+        case 0x00: 
+        // printf("Idle\r\n"); 
+        break;
+        default:   break;
+    }
+}
+
+/*******************************************************************************
+* Function Name: ble_input_get_notify_stats
+*******************************************************************************/
+void ble_input_get_notify_stats(ble_notify_stats_t *stats)
+{
+    *stats = notify_stats;
+}
+
+/*******************************************************************************
+* Function Name: ble_input_get_stats
+*******************************************************************************/
+void ble_input_get_stats(ble_input_stats_t *stats)
+{
+    *stats = input_stats;
+}
@@ -0,0 +1,77 @@
+#ifndef BLE_INPUT_H
+#define BLE_INPUT_H
+
+#include "main.h"
+
+/*
+ * Controller notifications, from the BLE stack to the Pi. The stack
+ * callback only copies each notification into a fixed ring (single
+ * producer, single consumer, no locks and no allocation) and wakes the
+ * input task, which decodes it, debounces gestures (MOVE_THRESHOLD) and
+ * writes the Pi protocol. A full ring drops the new notification.
+ *
+ * Every entry is stamped on arrival, so the input task knows how long it
+ * waited. Tilt samples older than INPUT_TILT_STALE_US are skipped, a newer
+ * one is behind them; gestures are always delivered.
+ */
+
+#define INPUT_RING_LEN          16      /* Power of two */
+#define INPUT_DATA_MAX          16      /* Longest notification kept, v2 gestures are 10 bytes */
+#define INPUT_TILT_STALE_US     50000
+
+#define INPUT_TASK_STACK_SIZE   512
+#define INPUT_TASK_PRIORITY     (configMAX_PRIORITIES - 3)  /* Above the BLE client task */
+
+/* Gesture notifications on the current connection (v2 packets carry a
+ * sequence number and the controller timestamp, legacy ones do not) */
+typedef struct {
+    uint32_t received;          /* v2 gesture packets accepted */
+    uint32_t legacy;            /* 1-byte gestures, not tracked */
+    uint32_t lost;              /* Sequence numbers never seen */
+    uint32_t duplicates;        /* Dropped, not forwarded to the Pi */
+    uint32_t reordered;         /* Arrived after a later sequence number */
+    uint32_t latency_avg_us;    /* Relative to the fastest packet, see ble_input.c */
+    uint32_t latency_max_us;
+    uint8_t button;             /* Controller button in the last packet */
+} ble_notify_stats_t;
+
+/* Ring and input task since boot. Latency runs from the stack callback to
+ * the Pi message being queued */
+typedef struct {
+    uint32_t queued;
+    uint32_t processed;         /* Decoded by the input task */
+    uint32_t overflow;          /* Ring full, dropped */
+    uint32_t oversize;          /* Longer than INPUT_DATA_MAX, dropped */
+    uint32_t stale;             /* Tilt samples skipped */
+    uint32_t latency_avg_us;
+    uint32_t latency_max_us;
+    uint8_t high_water;         /* Most entries waiting at once */
+} ble_input_stats_t;
+
+/**
+ * @brief Create the input task. Call before the BLE stack starts.
+ */
+cy_rslt_t ble_input_init(void);
+
+/**
+ * @brief Queue a notification, BLE stack callback only.
+ */
+void ble_input_notify(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief New connection: the gesture counters start again. Queued behind
+ * anything still in the ring, BLE stack callback only.
+ */
+void ble_input_connected(void);
+
+/**
+ * @brief Copy the gesture packet counters, reset on every connection.
+ */
+void ble_input_get_notify_stats(ble_notify_stats_t *stats);
+
+/**
+ * @brief Copy the ring and input task counters.
+ */
+void ble_input_get_stats(ble_input_stats_t *stats);
+
+#endif /* BLE_INPUT_H */
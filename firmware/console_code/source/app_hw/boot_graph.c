@@ -0,0 +1,70 @@
+#include "boot_graph.h"
+#include "boot_timeline.h"
+
+static const boot_job_t *boot_jobs = NULL;
+static uint8_t boot_job_count = 0;
+static EventGroupHandle_t boot_finished = NULL;
+static volatile uint32_t boot_failed = 0;
+
+static void boot_lane_task(void *param)
+{
+    uint8_t lane = (uint8_t)(uintptr_t)param;
+
+    for (uint8_t i = 0; i < boot_job_count; i++) {
+        const boot_job_t *job = &boot_jobs[i];
+        if (job->lane != lane) continue;
+
+        if (job->deps != 0) {
+            xEventGroupWaitBits(boot_finished, job->deps, pdFALSE, pdTRUE, portMAX_DELAY);
+        }
+
+        if ((boot_failed & job->deps) != 0 || job->run() != CY_RSLT_SUCCESS) {
+            taskENTER_CRITICAL();
+            boot_failed |= BOOT_JOB_BIT(i);
+            taskEXIT_CRITICAL();
+        } else {
+            boot_mark(job->name);
+        }
+        xEventGroupSetBits(boot_finished, BOOT_JOB_BIT(i));
+    }
+
+    vTaskDelete(NULL);
+}
+
+cy_rslt_t boot_graph_start(const boot_job_t *jobs, uint8_t count)
+{
+    uint8_t lanes = 0;
+
+    if (boot_finished != NULL || count == 0 || count > BOOT_GRAPH_JOBS_MAX) return CY_RSLT_TYPE_ERROR;
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (jobs[i].lane >= BOOT_GRAPH_LANES_MAX) return CY_RSLT_TYPE_ERROR;
+        if (jobs[i].lane >= lanes) lanes = jobs[i].lane + 1;
+    }
+
+    boot_finished = xEventGroupCreate();
+    if (boot_finished == NULL) return CY_RSLT_TYPE_ERROR;
+    boot_jobs = jobs;
+    boot_job_count = count;
+
+    for (uint8_t lane = 0; lane < lanes; lane++) {
+        if (xTaskCreate(boot_lane_task, "Boot lane", BOOT_GRAPH_STACK_SIZE, (void *)(uintptr_t)lane,
+                        BOOT_GRAPH_PRIORITY, NULL) != pdPASS) {
+            return CY_RSLT_TYPE_ERROR;
+        }
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+uint32_t boot_graph_failed(void)
+{
+    return boot_failed;
+}
+
+bool boot_graph_done(void)
+{
+    uint32_t all = BOOT_JOB_BIT(boot_job_count) - 1;
+
+    if (boot_finished == NULL) return false;
+    return (xEventGroupGetBits(boot_finished) & all) == all;
+}
@@ -0,0 +1,49 @@
+#ifndef BOOT_GRAPH_H
+#define BOOT_GRAPH_H
+
+#include "main.h"
+
+/*
+ * Boot dependency graph: init jobs run by a few short-lived "lane" tasks
+ * once the scheduler is up, so slow peripherals (TOF sensor, DAC) no longer
+ * hold back BLE scanning.
+ *
+ * Jobs in one lane run in table order, so a lane is used for jobs that
+ * share a bus. A job waits until every job in deps has finished; if any of
+ * them failed it is skipped and counts as failed too. deps may only name
+ * jobs in other lanes or earlier in the same lane. Each successful job
+ * marks its name on the boot timeline.
+ */
+
+#define BOOT_GRAPH_JOBS_MAX     24      /* Event group bits available */
+#define BOOT_GRAPH_LANES_MAX    4
+
+#define BOOT_GRAPH_STACK_SIZE   512
+#define BOOT_GRAPH_PRIORITY     (configMAX_PRIORITIES - 5)  /* Below the BLE task */
+
+#define BOOT_JOB_BIT(job)       (1UL << (job))
+
+typedef struct {
+    const char *name;           /* Also the boot timeline stage */
+    uint8_t lane;
+    uint32_t deps;              /* BOOT_JOB_BIT() of each job that must finish first */
+    cy_rslt_t (*run)(void);
+} boot_job_t;
+
+/**
+ * @brief Create the lane tasks. Call once, before or after the scheduler starts.
+ * @param jobs Table indexed by job number, must stay valid (static const)
+ */
+cy_rslt_t boot_graph_start(const boot_job_t *jobs, uint8_t count);
+
+/**
+ * @brief BOOT_JOB_BIT() of every job that failed or was skipped.
+ */
+uint32_t boot_graph_failed(void);
+
+/**
+ * @brief True once every job has run or been skipped.
+ */
+bool boot_graph_done(void);
+
+#endif /* BOOT_GRAPH_H */
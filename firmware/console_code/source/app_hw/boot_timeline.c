@@ -0,0 +1,50 @@
+#include "boot_timeline.h"
+#include "timestamp.h"
+#include <string.h>
+
+static boot_stage_t stages[BOOT_STAGE_MAX];
+static volatile uint8_t stage_count = 0;
+
+static int find_stage(const char *stage)
+{
+    for (uint8_t i = 0; i < stage_count; i++) {
+        if (strcmp(stages[i].stage, stage) == 0) return i;
+    }
+    return -1;
+}
+
+void boot_timeline_init(void)
+{
+    boot_mark("main");
+}
+
+void boot_mark(const char *stage)
+{
+    uint32_t now = timestamp_us();
+
+    taskENTER_CRITICAL();
+    if (stage_count < BOOT_STAGE_MAX && find_stage(stage) < 0) {
+        stages[stage_count].stage = stage;
+        stages[stage_count].time_us = now;
+        stage_count++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+uint32_t boot_stage_us(const char *stage)
+{
+    int i = find_stage(stage);
+    return (i < 0) ? 0 : stages[i].time_us;
+}
+
+uint8_t boot_stage_count(void)
+{
+    return stage_count;
+}
+
+bool boot_stage_get(uint8_t i, boot_stage_t *out)
+{
+    if (i >= stage_count) return false;
+    *out = stages[i];
+    return true;
+}
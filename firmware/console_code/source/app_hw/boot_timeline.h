@@ -0,0 +1,47 @@
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include "main.h"
+
+/*
+ * Boot timeline: each init stage marks itself once with a timestamp_us()
+ * stamp. The console has no debug printf (the Pi UART owns those pins), so
+ * the Pi reads the timeline back with the "BOOT" command.
+ */
+
+#define BOOT_STAGE_MAX          24
+
+typedef struct {
+    const char *stage;
+    uint32_t time_us;           /* Since timestamp_init() */
+} boot_stage_t;
+
+/**
+ * @brief Mark the "main" stage. Call from main after timestamp_init().
+ */
+void boot_timeline_init(void);
+
+/**
+ * @brief Record a stage. Only the first mark of a stage is kept, so it is
+ * safe to call from code that runs again later (e.g. on reconnect).
+ * @param stage String literal naming the stage
+ */
+void boot_mark(const char *stage);
+
+/**
+ * @brief Time a stage was reached in microseconds, 0 if it has not been.
+ */
+uint32_t boot_stage_us(const char *stage);
+
+/**
+ * @brief Number of stages recorded so far.
+ */
+uint8_t boot_stage_count(void);
+
+/**
+ * @brief Copy stage i (in the order they were reached).
+ * @return false if i is out of range
+ */
+bool boot_stage_get(uint8_t i, boot_stage_t *out);
+
+#endif /* BOOT_TIMELINE_H */
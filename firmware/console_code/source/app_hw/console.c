@@ -1,111 +1,152 @@
 #include "console.h"
 #include "task_ble.h"
+#include "boot_graph.h"
+#include "boot_timeline.h"
+#include "link_profile.h"
+#include "link_policy.h"
+#include "gatt_cache.h"
+#include "ble_input.h"
 
 //Global vars
 int16_t speaker_buffer[256];
 int wall_hit = 0;
 int dark_flag = 0;
-extern volatile uint8_t ble_motor_request;
 int TOF_activate = 1;
 
 
 static uint8_t current_high_score = 0;
 
-int console_init() {
+/*
+ * Boot graph, run by the boot lanes after the scheduler starts (see
+ * boot_graph.h). Lane 0 owns the main I2C bus (EEPROM, light sensor),
+ * lane 1 the TOF sensor bus and lane 2 the Pi UART and the speaker.
+ * The TOF bus waits for the main one because i2c_init() also creates
+ * Semaphore_I2C. Everything on the main bus takes Semaphore_I2C_Main, it
+ * is shared with the BLE task (GATT cache) and the Pi UART task.
+ */
+enum {
+    JOB_I2C,
+    JOB_EEPROM,
+    JOB_HIGH_SCORE,
+    JOB_GATT_CACHE,
+    JOB_LIGHT_SENSOR,
+    JOB_LR_TASK,
+    JOB_TOF_SENSOR,
+    JOB_TOF_TASK,
+    JOB_UART,
+    JOB_SPEAKER,
+    JOB_CHIME,
+    JOB_COUNT
+};
+
+static cy_rslt_t job_i2c(void)
+{
+    return i2c_init(MODULE_SITE_2);
+}
 
-    BaseType_t task_status;
-    cy_rslt_t result;
+static cy_rslt_t job_eeprom(void)
+{
+    return init_EEPROM();
+}
 
-    result = i2c_init(MODULE_SITE_2);
-    if (result != CY_RSLT_SUCCESS)
-    {
-        return -1;  //I2C not init
-    }
+static cy_rslt_t job_high_score(void)
+{
+    current_high_score = eeprom_read(0x01);
+    return CY_RSLT_SUCCESS;
+}
 
-    result = task_uart_init();
-    if (result != CY_RSLT_SUCCESS) {
-        return -2;
-    }
+/* The BLE task waits for the record before its first connection */
+static cy_rslt_t job_gatt_cache(void)
+{
+    cy_rslt_t rslt = gatt_cache_load();
 
-    uart_register_rx_callback(uart_score_callback);
+    task_ble_cache_ready();
+    return rslt;
+}
 
-    timer_init();
-    
-    result = init_EEPROM();
-    if (result != CY_RSLT_SUCCESS) {
-        return -3;
+static cy_rslt_t job_light_sensor(void)
+{
+    return light_sensor_init();
+}
+
+static cy_rslt_t job_lr_task(void)
+{
+    if (xTaskCreate(LR_task, "Light sensor task", 512, NULL, configMAX_PRIORITIES - 6, NULL) != pdPASS) {
+        return CY_RSLT_TYPE_ERROR;
     }
+    return CY_RSLT_SUCCESS;
+}
 
+static cy_rslt_t job_tof_sensor(void)
+{
+    return task_ir_init();
+}
 
-    result = light_sensor_init();
+static cy_rslt_t job_tof_task(void)
+{
+    if (xTaskCreate(TOF_task, "TOF task", 256, NULL, configMAX_PRIORITIES - 4, NULL) != pdPASS) {
+        return CY_RSLT_TYPE_ERROR;
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+static cy_rslt_t job_uart(void)
+{
+    cy_rslt_t result = task_uart_init();
     if (result != CY_RSLT_SUCCESS) {
-        return -4;
+        return result;
     }
+    uart_register_rx_callback(uart_score_callback);
+    return CY_RSLT_SUCCESS;
+}
 
+static cy_rslt_t job_speaker(void)
+{
+    return speakers_init();
+}
 
-    result = task_ir_init();
-    if (result != CY_RSLT_SUCCESS) {
-        return -5;
+/* Speaker_task plays the chime, the boot lane moves on straight away */
+static cy_rslt_t job_chime(void)
+{
+    if (xTaskCreate(Speaker_task, "Speaker task", 256, NULL, configMAX_PRIORITIES - 6, NULL) != pdPASS) {
+        return CY_RSLT_TYPE_ERROR;
     }
+    xEventGroupSetBits(wall_event, BOOT_CHIME_EVENT_BIT);
+    return CY_RSLT_SUCCESS;
+}
 
-    result = speakers_init();
-    if (result != CY_RSLT_SUCCESS) {
-        return -6;
+static const boot_job_t console_boot_jobs[JOB_COUNT] = {
+    [JOB_I2C]          = {"i2c",          0, 0, job_i2c},
+    [JOB_EEPROM]       = {"eeprom",       0, BOOT_JOB_BIT(JOB_I2C), job_eeprom},
+    [JOB_HIGH_SCORE]   = {"high score",   0, BOOT_JOB_BIT(JOB_I2C) | BOOT_JOB_BIT(JOB_EEPROM), job_high_score},
+    [JOB_GATT_CACHE]   = {"gatt cache",   0, BOOT_JOB_BIT(JOB_I2C) | BOOT_JOB_BIT(JOB_EEPROM), job_gatt_cache},
+    [JOB_LIGHT_SENSOR] = {"light sensor", 0, BOOT_JOB_BIT(JOB_I2C), job_light_sensor},
+    [JOB_LR_TASK]      = {"light task",   0, BOOT_JOB_BIT(JOB_LIGHT_SENSOR) | BOOT_JOB_BIT(JOB_UART), job_lr_task},
+    [JOB_TOF_SENSOR]   = {"tof sensor",   1, BOOT_JOB_BIT(JOB_I2C), job_tof_sensor},
+    [JOB_TOF_TASK]     = {"tof task",     1, BOOT_JOB_BIT(JOB_TOF_SENSOR) | BOOT_JOB_BIT(JOB_UART), job_tof_task},
+    [JOB_UART]         = {"uart",         2, 0, job_uart},
+    [JOB_SPEAKER]      = {"speaker",      2, 0, job_speaker},
+    [JOB_CHIME]        = {"chime",        2, BOOT_JOB_BIT(JOB_SPEAKER), job_chime},
+};
+
+/*
+ * Only what other tasks may touch as soon as the scheduler runs is set up
+ * here: the event groups (task_ble signals a connection on wall_event) and
+ * the 2 s sensor timer. Everything else is a boot graph job.
+ */
+int console_init() {
+
+    wall_event = xEventGroupCreate();
+    if (wall_event == NULL) {
+        return -1;
     }
 
+    timer_init();
 
-    task_status = xTaskCreate(
-      LR_task,
-      "Light sensor task",
-      512,
-      NULL,
-      configMAX_PRIORITIES - 6,
-      NULL);
-
-    if (task_status != pdPASS) {
-        return -7;
-    } 
-
-
-    task_status = xTaskCreate(
-      TOF_task,
-      "TOF task",
-      256,
-      NULL,
-      configMAX_PRIORITIES - 4,
-      NULL);
-
-    if (task_status != pdPASS) {
-        return -8;
-      } 
-
-    task_status = xTaskCreate(
-      EEPROM_task,
-      "EEPROM Task",
-      256,
-      NULL,
-      configMAX_PRIORITIES - 6,
-      NULL);
-
-    if (task_status != pdPASS) {
-        return -9;
-    }  
-
-
-    task_status = xTaskCreate(
-      Speaker_task,
-      "Speaker task",
-      256,
-      NULL,
-      configMAX_PRIORITIES - 6,
-      NULL);
-
-    if (task_status != pdPASS) {
-        return -10;
-      } 
+    if (boot_graph_start(console_boot_jobs, JOB_COUNT) != CY_RSLT_SUCCESS) {
+        return -2;
+    }
 
-    
-    // printf("All initialized\r\n");
     return 0;
 
 }
@@ -115,8 +156,112 @@ int console_init() {
 void uart_score_callback(uint8_t *data, uint16_t length)
 {
 
+    // "BOOT" reports the boot timeline, one "BOOT <us> <stage>" line per stage
+    if (length >= 4 && strncmp((char *)data, "BOOT", 4) == 0)
+    {
+        boot_stage_t stage;
+
+        for (uint8_t i = 0; boot_stage_get(i, &stage); i++) {
+            uart_printf("BOOT %lu %s\n", (unsigned long)stage.time_us, stage.stage);
+        }
+        uart_printf("BOOT failed 0x%03lx\n", (unsigned long)boot_graph_failed());
+    }
+    // "LINK" reports the gesture packet counters for this connection
+    else if (length >= 4 && strncmp((char *)data, "LINK", 4) == 0)
+    {
+        ble_notify_stats_t stats;
+
+        ble_input_get_notify_stats(&stats);
+        uart_printf("LINK %lu %lu %lu %lu %lu %lu\n", (unsigned long)stats.received,
+                    (unsigned long)stats.lost, (unsigned long)stats.duplicates,
+                    (unsigned long)stats.reordered, (unsigned long)stats.latency_avg_us,
+                    (unsigned long)stats.latency_max_us);
+    }
+    // "INPUT" reports the notification ring: queued, processed, overflow, oversize, stale, high water, latency avg/max us
+    else if (length >= 5 && strncmp((char *)data, "INPUT", 5) == 0)
+    {
+        ble_input_stats_t stats;
+
+        ble_input_get_stats(&stats);
+        uart_printf("INPUT %lu %lu %lu %lu %lu %u %lu %lu\n", (unsigned long)stats.queued,
+                    (unsigned long)stats.processed, (unsigned long)stats.overflow,
+                    (unsigned long)stats.oversize, (unsigned long)stats.stale, stats.high_water,
+                    (unsigned long)stats.latency_avg_us, (unsigned long)stats.latency_max_us);
+    }
+    // "UART" reports the Pi link: transmit bytes sent, bytes dropped, drops, errors, high water,
+    // then receive bytes, lines, interrupts, overflow, too long, errors
+    else if (length >= 4 && strncmp((char *)data, "UART", 4) == 0)
+    {
+        uart_tx_stats_t stats;
+        uart_rx_stats_t rx;
+
+        uart_get_tx_stats(&stats);
+        uart_get_rx_stats(&rx);
+        uart_printf("UART %lu %lu %lu %lu %u\n", (unsigned long)stats.bytes_sent,
+                    (unsigned long)stats.bytes_dropped, (unsigned long)stats.drops,
+                    (unsigned long)stats.errors, stats.high_water);
+        uart_printf("UART rx %lu %lu %lu %lu %lu %lu\n", (unsigned long)rx.bytes,
+                    (unsigned long)rx.lines, (unsigned long)rx.interrupts,
+                    (unsigned long)rx.overflow, (unsigned long)rx.too_long, (unsigned long)rx.errors);
+    }
+    // "GATT" reports the GATT client operation counters
+    else if (length >= 4 && strncmp((char *)data, "GATT", 4) == 0)
+    {
+        ble_gatt_stats_t stats;
+
+        task_ble_get_gatt_stats(&stats);
+        uart_printf("GATT %lu %lu %lu %lu %lu\n", (unsigned long)stats.issued,
+                    (unsigned long)stats.completed, (unsigned long)stats.failed,
+                    (unsigned long)stats.timeouts, (unsigned long)stats.dropped);
+        uart_printf("GATT cache %lu discovered %lu failed %lu last %lu us stale %lu\n", (unsigned long)stats.cache_hits,
+                    (unsigned long)stats.discoveries, (unsigned long)stats.discovery_failures,
+                    (unsigned long)stats.discovery_us, (unsigned long)stats.cache_stale);
+    }
+    // "CONN" reports the connection manager: connects, direct, direct timeouts, scans, backoffs, restore ms
+    else if (length >= 4 && strncmp((char *)data, "CONN", 4) == 0)
+    {
+        ble_conn_stats_t stats;
+
+        task_ble_get_conn_stats(&stats);
+        uart_printf("CONN %lu %lu %lu %lu %lu %lu %lu\n", (unsigned long)stats.connects,
+                    (unsigned long)stats.direct, (unsigned long)stats.direct_timeouts,
+                    (unsigned long)stats.scans, (unsigned long)stats.backoffs,
+                    (unsigned long)(stats.restore_us / 1000), (unsigned long)(stats.restore_max_us / 1000));
+    }
+    // "HAPTIC" reports the haptic command counters and latency
+    else if (length >= 6 && strncmp((char *)data, "HAPTIC", 6) == 0)
+    {
+        ble_haptic_stats_t stats;
+
+        task_ble_get_haptic_stats(&stats);
+        uart_printf("HAPTIC %lu %lu %lu %lu %lu %lu\n", (unsigned long)stats.requested,
+                    (unsigned long)stats.sent, (unsigned long)stats.dropped,
+                    (unsigned long)stats.latency_avg_us, (unsigned long)stats.latency_max_us,
+                    (unsigned long)stats.latency_last_us);
+    }
+    // "PROFILE" reports the negotiated link: interval (1.25 ms), latency, PHY, MTU, LL payload
+    else if (length >= 7 && strncmp((char *)data, "PROFILE", 7) == 0)
+    {
+        link_profile_t profile;
+
+        link_profile_get(&profile);
+        uart_printf("PROFILE %u %u %u %u %u 0x%02x %lu\n", profile.interval, profile.latency,
+                    profile.tx_phy, profile.mtu, profile.max_tx_octets, profile.refused,
+                    (unsigned long)(profile.settle_us / 1000));
+    }
+    // "POLICY" reports the last link switches: "POLICY <us> <FAST|RELAXED> <reason> <interval> <apply us>"
+    else if (length >= 6 && strncmp((char *)data, "POLICY", 6) == 0)
+    {
+        link_policy_transition_t entry;
+
+        for (uint8_t i = 0; link_policy_log_get(i, &entry); i++) {
+            uart_printf("POLICY %lu %s %s %u %lu\n", (unsigned long)entry.time_us,
+                        (entry.mode == LINK_POLICY_FAST) ? "FAST" : "RELAXED", entry.reason,
+                        entry.interval, (unsigned long)entry.apply_us);
+        }
+    }
     // Check if received data is "MENU"
-    if (length >= 4 && strncmp((char *)data, "MENU", 4) == 0)
+    else if (length >= 4 && strncmp((char *)data, "MENU", 4) == 0)
     {
         // Read high score from EEPROM
         current_high_score = eeprom_read(0x01);
@@ -127,6 +272,7 @@ void uart_score_callback(uint8_t *data, uint16_t length)
         uart_send_string(msg);
         
         TOF_activate = 1;
+        link_policy_game_event(LINK_GAME_MENU);
             
 
     }
@@ -138,6 +284,7 @@ void uart_score_callback(uint8_t *data, uint16_t length)
 
     else if (strncmp((char*)data, "WIN ", 4) == 0)
     {
+        link_policy_game_event(LINK_GAME_WON);
         if (wall_event != NULL) {
         xEventGroupSetBits(wall_event, VICTORY_EVENT_BIT);
         }
@@ -157,6 +304,7 @@ void uart_score_callback(uint8_t *data, uint16_t length)
     }
     else if (strncmp((char*)data, "VIC", 3) == 0)
     {
+        link_policy_game_event(LINK_GAME_WON);
         if (wall_event != NULL) {
         xEventGroupSetBits(wall_event, VICTORY_EVENT_BIT);
         }
@@ -167,25 +315,15 @@ void uart_score_callback(uint8_t *data, uint16_t length)
     else if (length >= 5 && strncmp((char *)data, "LEVEL", 5) == 0)
     {
                 TOF_activate = 1;
+        link_policy_game_event(LINK_GAME_LEVEL);
         
     }
-
-}
-
-void EEPROM_task(void *param)
-{
-
-    (void)param;
-    vTaskDelay(pdMS_TO_TICKS(200));
-
-    current_high_score = eeprom_read(0x01);
-    // printf("eeprom read\r\n");
-    
- 
-    for (;;)    
+    else if (length >= 8 && strncmp((char *)data, "ANALOG ", 7) == 0)
     {
-        vTaskDelay(pdMS_TO_TICKS(100));
+        /* "ANALOG 1" streams tilt as "A <x> <y>" frames, "ANALOG 0" goes back to discrete */
+        task_ble_set_report_mode((data[7] == '1') ? REPORT_MODE_ANALOG : REPORT_MODE_DISCRETE);
     }
+
 }
 
 void LR_task(void *param) {
@@ -193,8 +331,7 @@ void LR_task(void *param) {
     (void)param;
 
     char msg[16];
-    vTaskDelay(pdMS_TO_TICKS(3000));
-    
+
 
     while(1) {
     EventBits_t bits = xEventGroupWaitBits(
@@ -225,8 +362,7 @@ void LR_task(void *param) {
 void TOF_task(void *param) {
 
     (void)param;
-    vTaskDelay(pdMS_TO_TICKS(3000));
-    
+
 
     while(1) {
     EventBits_t bits = xEventGroupWaitBits(
@@ -280,14 +416,19 @@ void Speaker_task(void* pvParameters) {
         // We act as a listener for EITHER a wall hit OR a victory
         EventBits_t bits = xEventGroupWaitBits(
             wall_event,                        
-            WALL_EVENT_BIT | VICTORY_EVENT_BIT | CONNECTION_EVENT_BIT, // <--- YOU MUST ADD THIS PART
+            WALL_EVENT_BIT | VICTORY_EVENT_BIT | CONNECTION_EVENT_BIT | BOOT_CHIME_EVENT_BIT, // <--- YOU MUST ADD THIS PART
             pdTRUE,                   
             pdFALSE,                  
             portMAX_DELAY             
         );
 
+        if (bits & BOOT_CHIME_EVENT_BIT) {
+            speaker_startup(speaker_buffer, 256, 16800);
+            speaker_mario_coin(speaker_buffer, 256, AUDIO_SAMPLE_RATE_HZ);
+        }
+
         if (bits & WALL_EVENT_BIT) { 
-            task_ble_send_motor_cmd(ble_motor_request);
+            task_ble_haptic(HAPTIC_STRENGTH_DEFAULT, HAPTIC_DURATION_DEFAULT_MS);
             // speaker_wall_bump(speaker_buffer, 256, AUDIO_SAMPLE_RATE_HZ); // Use your preferred sound here
              wall_hit_note(speaker_buffer, 256, AUDIO_SAMPLE_RATE_HZ, 880.0);
             // speaker_mario(speaker_buffer, 256, AUDIO_SAMPLE_RATE_HZ);
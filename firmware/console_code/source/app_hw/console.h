@@ -17,7 +17,6 @@
 
 int console_init();
 void uart_score_callback(uint8_t *data, uint16_t length);
-void EEPROM_task(void *param);
 void LR_task(void *param);
 void TOF_task(void *param);
 void Speaker_task(void *param);
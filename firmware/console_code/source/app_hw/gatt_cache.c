@@ -0,0 +1,105 @@
+#include "gatt_cache.h"
+#include "EEPROM.h"
+#include <stddef.h>
+#include <string.h>
+
+#define GATT_CACHE_MAGIC        0xA2    /* Bump when the record layout changes */
+
+/* Writes the record, about 100 ms of EEPROM write cycles, off the BLE task */
+#define GATT_CACHE_TASK_STACK_SIZE  256
+#define GATT_CACHE_TASK_PRIORITY    (tskIDLE_PRIORITY + 1)
+
+typedef struct __attribute__((packed)) {
+    uint8_t magic;
+    uint8_t bd_addr[6];
+    uint8_t addr_type;          /* wiced_bt_ble_address_type_t, for connecting without a scan */
+    uint8_t hash[GATT_CACHE_HASH_LEN];
+    gatt_handles_t handles;
+    uint8_t checksum;           /* XOR of the bytes before it */
+} gatt_cache_record_t;
+
+static gatt_cache_record_t cache;
+static volatile bool cache_valid = false;
+static gatt_cache_record_t store_pending;      /* Next record to write, see store_task() */
+static TaskHandle_t store_task_handle = NULL;
+
+/* Helper: XOR of every byte before the checksum */
+static uint8_t record_checksum(const gatt_cache_record_t *record)
+{
+    const uint8_t *p = (const uint8_t *)record;
+    uint8_t sum = 0;
+
+    for (uint8_t i = 0; i < offsetof(gatt_cache_record_t, checksum); i++) sum ^= p[i];
+    return sum;
+}
+
+/* Task: Write the latest stored record. Another store during the write
+   leaves a notification, so the newer record follows */
+static void store_task(void *arg)
+{
+    gatt_cache_record_t record;
+
+    (void)arg;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        taskENTER_CRITICAL();
+        record = store_pending;
+        taskEXIT_CRITICAL();
+
+        eeprom_write_block(GATT_CACHE_EEPROM_ADDR, (const uint8_t *)&record, sizeof(record));
+    }
+}
+
+cy_rslt_t gatt_cache_load(void)
+{
+    eeprom_read_block(GATT_CACHE_EEPROM_ADDR, (uint8_t *)&cache, sizeof(cache));
+
+    /* A blank or stale EEPROM is not an error, the controller is discovered instead */
+    cache_valid = (cache.magic == GATT_CACHE_MAGIC && cache.checksum == record_checksum(&cache));
+
+    if (xTaskCreate(store_task, "GATT cache", GATT_CACHE_TASK_STACK_SIZE, NULL,
+                    GATT_CACHE_TASK_PRIORITY, &store_task_handle) != pdPASS) {
+        return CY_RSLT_TYPE_ERROR;
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+bool gatt_cache_lookup(const uint8_t *bd_addr, const uint8_t *hash, gatt_handles_t *handles)
+{
+    if (!cache_valid) return false;
+    if (memcmp(cache.bd_addr, bd_addr, sizeof(cache.bd_addr)) != 0) return false;
+    if (memcmp(cache.hash, hash, GATT_CACHE_HASH_LEN) != 0) return false;
+
+    *handles = cache.handles;
+    return true;
+}
+
+bool gatt_cache_peer(uint8_t *bd_addr, uint8_t *addr_type, uint8_t *hash)
+{
+    if (!cache_valid) return false;
+
+    memcpy(bd_addr, cache.bd_addr, sizeof(cache.bd_addr));
+    *addr_type = cache.addr_type;
+    memcpy(hash, cache.hash, GATT_CACHE_HASH_LEN);
+    return true;
+}
+
+void gatt_cache_store(const uint8_t *bd_addr, uint8_t addr_type, const uint8_t *hash,
+                      const gatt_handles_t *handles)
+{
+    cache_valid = false;
+    cache.magic = GATT_CACHE_MAGIC;
+    memcpy(cache.bd_addr, bd_addr, sizeof(cache.bd_addr));
+    cache.addr_type = addr_type;
+    memcpy(cache.hash, hash, GATT_CACHE_HASH_LEN);
+    cache.handles = *handles;
+    cache.checksum = record_checksum(&cache);
+    cache_valid = true;
+
+    if (store_task_handle == NULL) return;
+    taskENTER_CRITICAL();
+    store_pending = cache;
+    taskEXIT_CRITICAL();
+    xTaskNotifyGive(store_task_handle);
+}
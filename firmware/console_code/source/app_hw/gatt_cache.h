@@ -0,0 +1,51 @@
+#ifndef GATT_CACHE_H
+#define GATT_CACHE_H
+
+#include "main.h"
+
+/*
+ * Controller GATT handles, cached in the console EEPROM. The record holds
+ * the controller address, the database hash it advertises and the handles
+ * discovery found for it. A controller advertising the same hash has the
+ * same database, so its handles are used without discovery; a new
+ * controller firmware changes the hash and is discovered once.
+ *
+ * Every new controller is discovered, so the record is also the last
+ * controller the console connected to: the connection manager in task_ble.c
+ * connects to it directly after power-on or a link loss.
+ */
+
+#define GATT_CACHE_HASH_LEN         8       /* Leading bytes of the database hash, as advertised */
+#define GATT_CACHE_EEPROM_ADDR      0x10    /* Clear of the high score at 0x01 */
+
+typedef struct {
+    uint16_t data_value;        /* Gesture notifications */
+    uint16_t data_cccd;
+    uint16_t command_value;     /* Haptic and mode commands */
+} gatt_handles_t;
+
+/**
+ * @brief Read the record from EEPROM and start the task that writes it.
+ * Boot job, after the EEPROM is up.
+ */
+cy_rslt_t gatt_cache_load(void);
+
+/**
+ * @brief Handles for this controller and database hash, if cached.
+ */
+bool gatt_cache_lookup(const uint8_t *bd_addr, const uint8_t *hash, gatt_handles_t *handles);
+
+/**
+ * @brief The controller in the record, its address type and database hash.
+ * @return false if the record is blank or not loaded yet
+ */
+bool gatt_cache_peer(uint8_t *bd_addr, uint8_t *addr_type, uint8_t *hash);
+
+/**
+ * @brief Replace the record. Lookups see it at once; the EEPROM write, about
+ * 100 ms byte by byte, is left to a low priority task.
+ */
+void gatt_cache_store(const uint8_t *bd_addr, uint8_t addr_type, const uint8_t *hash,
+                      const gatt_handles_t *handles);
+
+#endif /* GATT_CACHE_H */
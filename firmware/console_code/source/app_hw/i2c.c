@@ -14,6 +14,7 @@
 cyhal_i2c_t i2c_master_obj1;
 cyhal_i2c_t i2c_master_obj2;
 SemaphoreHandle_t Semaphore_I2C;
+SemaphoreHandle_t Semaphore_I2C_Main;
 
 // Define the I2C master configuration structure
 cyhal_i2c_cfg_t i2c_master_config =
@@ -90,6 +91,15 @@ cy_rslt_t i2c_init(module_site_t module_site)
 		{
 			return rslt;
 		}
+
+		/* The main bus is shared by the light sensor task, the UART task and
+		   the BLE task (GATT cache). A mutex, so a long EEPROM write in a
+		   low priority task is not stuck behind the tasks in between */
+		Semaphore_I2C_Main = xSemaphoreCreateMutex();
+		if (Semaphore_I2C_Main == NULL)
+		{
+			return CY_RSLT_TYPE_ERROR;
+		}
 	}
 
 	if (module_site == MODULE_SITE_1) { 
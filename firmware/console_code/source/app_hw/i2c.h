@@ -18,6 +18,7 @@
 extern cyhal_i2c_t i2c_master_obj1;
 extern cyhal_i2c_t i2c_master_obj2;
 extern SemaphoreHandle_t Semaphore_I2C;
+extern SemaphoreHandle_t Semaphore_I2C_Main;    /* i2c_master_obj2: EEPROM, light sensor */
 
 
 /* Public API */
@@ -1,6 +1,5 @@
 #include "light_sensor.h"
-
-extern cyhal_i2c_t i2c_master_obj2;
+#include "i2c.h"
 
 uint8_t ltr_reg_read(uint8_t reg);
 
@@ -52,12 +51,17 @@ uint8_t ltr_reg_read(uint8_t reg)
     uint8_t return_val;
     uint8_t write_data = reg;
     uint8_t read_data[2];
+
+    xSemaphoreTake(Semaphore_I2C_Main, portMAX_DELAY);
+
     rslt = cyhal_i2c_master_write(&i2c_master_obj2, LTR_SUBORDINATE_ADDR, &write_data, 1, 0, false);
     CY_ASSERT(rslt == CY_RSLT_SUCCESS);
 
     rslt = cyhal_i2c_master_read(&i2c_master_obj2, LTR_SUBORDINATE_ADDR, read_data, 1, 0 , true); 
     CY_ASSERT(rslt == CY_RSLT_SUCCESS);
 
+    xSemaphoreGive(Semaphore_I2C_Main);
+
 
     return_val = read_data[0];
     return return_val;
@@ -113,11 +117,15 @@ void ltr_light_sensor_start(void)
     uint8_t write1[] = {LTR_REG_CONTR, write_data[0]};
     uint8_t write2[] = {LTR_REG_CONTR, write_data[1]};
 
+    xSemaphoreTake(Semaphore_I2C_Main, portMAX_DELAY);
+
     rslt = cyhal_i2c_master_write(&i2c_master_obj2, LTR_SUBORDINATE_ADDR, write2, 2, 0 ,true);  
     CY_ASSERT(rslt == CY_RSLT_SUCCESS);
 
     rslt = cyhal_i2c_master_write(&i2c_master_obj2, LTR_SUBORDINATE_ADDR, write1, 2, 0 ,true);  
     CY_ASSERT(rslt == CY_RSLT_SUCCESS);
+
+    xSemaphoreGive(Semaphore_I2C_Main);
 }
 
 cy_rslt_t light_sensor_init() {
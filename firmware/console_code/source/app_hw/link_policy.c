@@ -0,0 +1,150 @@
+#include "link_policy.h"
+#include "link_profile.h"
+#include "timestamp.h"
+#include "task_ble.h"
+#include "timers.h"
+
+#define POLICY_NO_PENDING       0xFFFFFFFFUL
+
+static const char *const game_event_names[] = {"menu", "level", "won", "pause", "unpause"};
+
+static TimerHandle_t quiet_timer = NULL;
+
+/* Written by the inputs, so repeats and gestures during play cost nothing */
+static volatile int8_t last_game_event = -1;
+static volatile bool fast_playing = false;
+
+/* Owned by the timer service task */
+static link_policy_mode_t policy_mode = LINK_POLICY_FAST;
+static bool game_idle = true;           /* Menu or victory screen */
+static bool game_paused = false;
+static uint32_t pending_entry = POLICY_NO_PENDING;
+
+static link_policy_transition_t policy_log[LINK_POLICY_LOG_LEN];
+static uint32_t policy_log_count = 0;
+
+/* Helper: Switch the link and log it, nothing if already there. The BLE
+   task makes the request, it owns the stack calls */
+static void switch_mode(link_policy_mode_t mode, const char *reason)
+{
+    link_policy_transition_t *entry;
+    bool requested;
+
+    fast_playing = (mode == LINK_POLICY_FAST && !game_idle && !game_paused);
+    if (mode == policy_mode) return;
+    policy_mode = mode;
+
+    requested = link_profile_set_relaxed(mode == LINK_POLICY_RELAXED);
+    if (requested) task_ble_update_link();
+
+    taskENTER_CRITICAL();
+    entry = &policy_log[policy_log_count % LINK_POLICY_LOG_LEN];
+    entry->time_us = timestamp_us();
+    entry->apply_us = 0;
+    entry->interval = 0;
+    entry->mode = mode;
+    entry->reason = reason;
+    pending_entry = requested ? policy_log_count : POLICY_NO_PENDING;
+    policy_log_count++;
+    taskEXIT_CRITICAL();
+}
+
+static void policy_game_event(void *param, uint32_t event)
+{
+    (void)param;
+
+    switch (event) {
+        case LINK_GAME_MENU:
+        case LINK_GAME_WON:     game_idle = true;       break;
+        case LINK_GAME_LEVEL:   game_idle = false;      break;
+        case LINK_GAME_PAUSE:   game_paused = true;     break;
+        case LINK_GAME_UNPAUSE: game_paused = false;    break;
+        default:                return;
+    }
+
+    if (!game_idle && !game_paused) {
+        xTimerStop(quiet_timer, 0);
+        switch_mode(LINK_POLICY_FAST, game_event_names[event]);
+    } else if (xTimerIsTimerActive(quiet_timer) == pdFALSE) {
+        /* A running quiet timer means the player is navigating, it relaxes the link when done */
+        switch_mode(LINK_POLICY_RELAXED, game_event_names[event]);
+    } else {
+        fast_playing = false;
+    }
+}
+
+static void policy_gesture(void *param, uint32_t unused)
+{
+    (void)param;
+    (void)unused;
+
+    if (!game_idle && !game_paused) return;
+    xTimerReset(quiet_timer, 0);
+    switch_mode(LINK_POLICY_FAST, "gesture");
+}
+
+static void quiet_timer_callback(TimerHandle_t timer)
+{
+    (void)timer;
+    if (game_idle || game_paused) switch_mode(LINK_POLICY_RELAXED, "quiet");
+}
+
+static void policy_link_updated(void *param, uint32_t update)
+{
+    link_policy_transition_t *entry;
+
+    (void)param;
+    if (pending_entry == POLICY_NO_PENDING || (update >> 16) != 0) return;
+
+    taskENTER_CRITICAL();
+    if (policy_log_count - pending_entry <= LINK_POLICY_LOG_LEN) {
+        entry = &policy_log[pending_entry % LINK_POLICY_LOG_LEN];
+        entry->apply_us = timestamp_us() - entry->time_us;
+        entry->interval = (uint16_t)update;
+    }
+    pending_entry = POLICY_NO_PENDING;
+    taskEXIT_CRITICAL();
+}
+
+cy_rslt_t link_policy_init(void)
+{
+    quiet_timer = xTimerCreate("Link Quiet", pdMS_TO_TICKS(LINK_POLICY_QUIET_MS), pdFALSE, NULL, quiet_timer_callback);
+    if (quiet_timer == NULL) return CY_RSLT_TYPE_ERROR;
+
+    /* The console boots into the menu */
+    switch_mode(LINK_POLICY_RELAXED, "boot");
+    return CY_RSLT_SUCCESS;
+}
+
+void link_policy_game_event(link_game_event_t event)
+{
+    if ((int8_t)event == last_game_event) return;
+    last_game_event = (int8_t)event;
+    xTimerPendFunctionCall(policy_game_event, NULL, (uint32_t)event, 0);
+}
+
+void link_policy_gesture(void)
+{
+    if (fast_playing) return;
+    xTimerPendFunctionCall(policy_gesture, NULL, 0, 0);
+}
+
+void link_policy_link_updated(uint8_t status, uint16_t interval)
+{
+    xTimerPendFunctionCall(policy_link_updated, NULL, ((uint32_t)status << 16) | interval, 0);
+}
+
+bool link_policy_log_get(uint8_t i, link_policy_transition_t *out)
+{
+    uint32_t first;
+    bool found = false;
+
+    taskENTER_CRITICAL();
+    first = (policy_log_count > LINK_POLICY_LOG_LEN) ? policy_log_count - LINK_POLICY_LOG_LEN : 0;
+    if (first + i < policy_log_count) {
+        *out = policy_log[(first + i) % LINK_POLICY_LOG_LEN];
+        found = true;
+    }
+    taskEXIT_CRITICAL();
+    return found;
+}
@@ -0,0 +1,73 @@
+#ifndef LINK_POLICY_H
+#define LINK_POLICY_H
+
+#include "main.h"
+
+/*
+ * Connection parameter policy. The fast link (7.5 ms, no slave latency)
+ * is only needed while a level is being played; in the menu, on the
+ * victory screen and while paused the link is relaxed so the controller
+ * can sleep through most connection events (see LINK_IDLE_INTERVAL).
+ *
+ * Game state comes from the Pi ("MENU", "LEVEL", "WIN"/"VIC") and from the
+ * pause sensor ("PAUSE"/"UNPAUSE"). A gesture on a relaxed link switches
+ * back to fast at once, since the player is navigating; it relaxes again
+ * after LINK_POLICY_QUIET_MS without gestures if the game is still idle.
+ *
+ * Inputs may come from any task or the BLE stack; the decisions all run in
+ * the timer service task, and the BLE task requests the new interval
+ * (link_profile_update()). Every switch is logged with the time it took the
+ * link to follow, read back with the "POLICY" command.
+ */
+
+#define LINK_POLICY_QUIET_MS        10000
+#define LINK_POLICY_LOG_LEN         8
+
+typedef enum {
+    LINK_GAME_MENU,
+    LINK_GAME_LEVEL,
+    LINK_GAME_WON,
+    LINK_GAME_PAUSE,
+    LINK_GAME_UNPAUSE
+} link_game_event_t;
+
+typedef enum {
+    LINK_POLICY_FAST,
+    LINK_POLICY_RELAXED
+} link_policy_mode_t;
+
+typedef struct {
+    uint32_t time_us;           /* timestamp_us() of the decision */
+    uint32_t apply_us;          /* Until the link reported the new interval, 0 = not yet / not connected */
+    uint16_t interval;          /* Interval the link reported, 1.25 ms units */
+    uint8_t mode;               /* link_policy_mode_t */
+    const char *reason;
+} link_policy_transition_t;
+
+/**
+ * @brief Create the quiet timer. Call before the BLE stack starts.
+ */
+cy_rslt_t link_policy_init(void);
+
+/**
+ * @brief Game state change. Repeats of the last event are ignored.
+ */
+void link_policy_game_event(link_game_event_t event);
+
+/**
+ * @brief A gesture arrived from the controller.
+ */
+void link_policy_gesture(void);
+
+/**
+ * @brief Connection parameter update from the stack, status 0 on success.
+ */
+void link_policy_link_updated(uint8_t status, uint16_t interval);
+
+/**
+ * @brief Copy transition i, oldest first.
+ * @return false if i is out of range
+ */
+bool link_policy_log_get(uint8_t i, link_policy_transition_t *out);
+
+#endif /* LINK_POLICY_H */
@@ -0,0 +1,196 @@
+#include "link_profile.h"
+#include "timestamp.h"
+#include "cycfg_gap.h"
+#include <string.h>
+
+static const uint16_t link_intervals[] = LINK_INTERVALS;
+#define LINK_INTERVAL_STEPS     (sizeof(link_intervals) / sizeof(link_intervals[0]))
+
+static link_profile_t profile;
+static uint16_t link_conn_id = 0;
+static wiced_bt_device_address_t link_bd_addr;
+static uint32_t link_connected_us = 0;
+static volatile bool link_relaxed = false;
+
+/* Flagged from any task or the stack, acted on in link_profile_update() */
+static volatile bool interval_due = false;      /* Request the interval again */
+static volatile bool interval_refused = false;  /* The last step was refused, try the next */
+static bool intervals_exhausted = false;        /* BLE task only, LINK_REFUSED_INTERVAL */
+
+/* Helper: Fall back to the next interval, false if there is none */
+static bool next_interval(void)
+{
+    if (profile.interval_step + 1u < LINK_INTERVAL_STEPS) {
+        profile.interval_step++;
+        return true;
+    }
+    intervals_exhausted = true;
+    return false;
+}
+
+static void request_interval(void)
+{
+    if (link_relaxed) {
+        wiced_bt_l2cap_update_ble_conn_params(link_bd_addr, LINK_IDLE_INTERVAL, LINK_IDLE_INTERVAL,
+                                              LINK_IDLE_LATENCY, LINK_IDLE_SUPERVISION_TIMEOUT);
+        return;
+    }
+    while (!wiced_bt_l2cap_update_ble_conn_params(link_bd_addr, link_intervals[profile.interval_step],
+                                                  link_intervals[profile.interval_step], LINK_LATENCY,
+                                                  LINK_SUPERVISION_TIMEOUT)) {
+        if (!next_interval()) return;
+    }
+}
+
+void link_profile_connected(uint16_t conn_id, const wiced_bt_device_address_t bd_addr)
+{
+    wiced_bt_ble_phy_preferences_t phy;
+
+    memset(&profile, 0, sizeof(profile));
+    intervals_exhausted = false;
+    interval_refused = false;
+    interval_due = true;
+    profile.mtu = LINK_DEFAULT_MTU;
+    profile.tx_phy = LINK_PHY_1M;
+    profile.rx_phy = LINK_PHY_1M;
+    profile.max_tx_octets = LINK_DEFAULT_OCTETS;
+    profile.max_rx_octets = LINK_DEFAULT_OCTETS;
+    link_conn_id = conn_id;
+    memcpy(link_bd_addr, bd_addr, BD_ADDR_LEN);
+    link_connected_us = timestamp_us();
+
+    /* The link layer runs one procedure at a time and queues the rest; the
+       interval follows from the BLE task once it sees the link */
+    memset(&phy, 0, sizeof(phy));
+    memcpy(phy.remote_bd_addr, bd_addr, BD_ADDR_LEN);
+    phy.tx_phys = BTM_BLE_PREFER_2M_PHY;
+    phy.rx_phys = BTM_BLE_PREFER_2M_PHY;
+    if (wiced_bt_ble_set_phy(&phy) != WICED_BT_SUCCESS) {
+        profile.refused |= LINK_REFUSED_PHY;
+    }
+
+    if (wiced_bt_ble_set_data_packet_length(link_bd_addr, LINK_DLE_TX_OCTETS, LINK_DLE_TX_TIME_US) != WICED_BT_SUCCESS) {
+        profile.refused |= LINK_REFUSED_DLE;
+    }
+}
+
+void link_profile_disconnected(void)
+{
+    link_conn_id = 0;
+    profile.interval = 0;
+}
+
+bool link_profile_set_relaxed(bool relaxed)
+{
+    if (relaxed == link_relaxed) return false;
+    link_relaxed = relaxed;
+    if (link_conn_id == 0) return false;
+
+    interval_due = true;
+    return true;
+}
+
+void link_profile_update(void)
+{
+    bool due;
+    bool refused;
+
+    if (link_conn_id == 0) return;
+
+    taskENTER_CRITICAL();
+    due = interval_due;
+    refused = interval_refused;
+    interval_due = false;
+    interval_refused = false;
+    taskEXIT_CRITICAL();
+
+    if (refused && !link_relaxed && next_interval()) due = true;
+    if (due) request_interval();
+}
+
+bool link_profile_request_mtu(void)
+{
+    if (link_conn_id == 0 || CY_BT_MTU_SIZE <= LINK_DEFAULT_MTU) return false;
+
+    if (wiced_bt_gatt_client_configure_mtu(link_conn_id, CY_BT_MTU_SIZE) != WICED_BT_GATT_SUCCESS) {
+        profile.refused |= LINK_REFUSED_MTU;
+        return false;
+    }
+    return true;
+}
+
+void link_profile_mtu_done(wiced_bt_gatt_status_t status, uint16_t mtu)
+{
+    if (status == WICED_BT_GATT_SUCCESS && mtu > LINK_DEFAULT_MTU) {
+        profile.mtu = mtu;
+    } else {
+        profile.refused |= LINK_REFUSED_MTU;
+    }
+    profile.settle_us = timestamp_us() - link_connected_us;
+}
+
+bool link_profile_mgmt_event(wiced_bt_management_evt_t event, wiced_bt_management_evt_data_t *p_event_data)
+{
+    bool update = false;
+
+    if (link_conn_id == 0) return false;
+
+    switch (event)
+    {
+        case BTM_BLE_CONNECTION_PARAM_UPDATE:
+        {
+            wiced_bt_ble_connection_param_update_t *p = &p_event_data->ble_connection_param_update;
+            if (memcmp(p->bd_addr, link_bd_addr, BD_ADDR_LEN) != 0) return false;
+
+            if (p->status == 0) {
+                profile.interval = p->conn_interval;
+                profile.latency = p->conn_latency;
+                profile.supervision_timeout = p->supervision_timeout;
+            }
+            /* Refused, or the controller picked something slower: try the next step */
+            if (!link_relaxed &&
+                (p->status != 0 || p->conn_interval > link_intervals[profile.interval_step]) &&
+                !intervals_exhausted) {
+                interval_refused = true;
+                update = true;
+            }
+            break;
+        }
+
+        case BTM_BLE_PHY_UPDATE_EVT:
+        {
+            wiced_bt_ble_phy_update_t *p = &p_event_data->ble_phy_update_event;
+            if (memcmp(p->bd_addr, link_bd_addr, BD_ADDR_LEN) != 0) return false;
+
+            if (p->status == 0) {
+                profile.tx_phy = p->tx_phy;
+                profile.rx_phy = p->rx_phy;
+            }
+            if (p->status != 0 || p->tx_phy != LINK_PHY_2M) profile.refused |= LINK_REFUSED_PHY;
+            break;
+        }
+
+        case BTM_BLE_DATA_LENGTH_UPDATE_EVENT:
+        {
+            wiced_bt_ble_data_length_update_t *p = &p_event_data->ble_data_length_update_event;
+            if (memcmp(p->bd_addr, link_bd_addr, BD_ADDR_LEN) != 0) return false;
+
+            profile.max_tx_octets = p->max_tx_octets;
+            profile.max_rx_octets = p->max_rx_octets;
+            if (p->max_tx_octets <= LINK_DEFAULT_OCTETS) profile.refused |= LINK_REFUSED_DLE;
+            break;
+        }
+
+        default:
+            return false;
+    }
+
+    profile.settle_us = timestamp_us() - link_connected_us;
+    return update;
+}
+
+void link_profile_get(link_profile_t *out)
+{
+    *out = profile;
+    if (intervals_exhausted) out->refused |= LINK_REFUSED_INTERVAL;
+}
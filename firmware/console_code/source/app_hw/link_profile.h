@@ -0,0 +1,112 @@
+#ifndef LINK_PROFILE_H
+#define LINK_PROFILE_H
+
+#include "main.h"
+#include "wiced_bt_dev.h"
+#include "wiced_bt_ble.h"
+#include "wiced_bt_gatt.h"
+
+/*
+ * Link profile manager, central side. Once connected it asks for the
+ * shortest connection interval the controller accepts, 2M PHY, LE data
+ * length extension and (after the CCCD write) a larger ATT MTU, and keeps
+ * what was actually agreed. A refused request leaves the link as it was:
+ * the interval steps down LINK_INTERVALS, the PHY stays 1M, the MTU 23 and
+ * the LL payload 27 bytes.
+ *
+ * While relaxed (see link_policy.h) the interval is LINK_IDLE_INTERVAL with
+ * slave latency instead; leaving relaxed goes back to the fastest step the
+ * controller accepted.
+ *
+ * Interval requests are only made by the BLE task, in link_profile_update();
+ * the other calls just flag that one is due and the caller wakes the task.
+ */
+
+/* Connection intervals tried in order, 1.25 ms units (7.5, 10, 15 ms) */
+#define LINK_INTERVALS              { 6, 8, 12 }
+#define LINK_LATENCY                0
+#define LINK_SUPERVISION_TIMEOUT    100     /* 10 ms units */
+
+/* Relaxed link, 50 ms interval. The controller may skip 4 events when it has
+   nothing to send, so it listens every 250 ms; the timeout must cover that twice */
+#define LINK_IDLE_INTERVAL          40
+#define LINK_IDLE_LATENCY           4
+#define LINK_IDLE_SUPERVISION_TIMEOUT   400
+
+#define LINK_DEFAULT_MTU            23      /* ATT default, before the exchange */
+#define LINK_DEFAULT_OCTETS         27      /* LL payload without DLE */
+#define LINK_DLE_TX_OCTETS          251
+#define LINK_DLE_TX_TIME_US         2120    /* 251 bytes at 1M, so either PHY works */
+
+/* PHY as reported by the link layer */
+#define LINK_PHY_1M                 1
+#define LINK_PHY_2M                 2
+
+/* Requests the peer turned down */
+#define LINK_REFUSED_INTERVAL       0x01    /* Every step of LINK_INTERVALS */
+#define LINK_REFUSED_PHY            0x02
+#define LINK_REFUSED_DLE            0x04
+#define LINK_REFUSED_MTU            0x08
+
+typedef struct {
+    uint16_t interval;              /* 1.25 ms units, 0 = unknown / not connected */
+    uint16_t latency;
+    uint16_t supervision_timeout;   /* 10 ms units */
+    uint16_t mtu;
+    uint8_t tx_phy;                 /* LINK_PHY_x */
+    uint8_t rx_phy;
+    uint16_t max_tx_octets;
+    uint16_t max_rx_octets;
+    uint8_t interval_step;          /* Index into LINK_INTERVALS last requested */
+    uint8_t refused;                /* LINK_REFUSED_x */
+    uint32_t settle_us;             /* Connection to the last update, from timestamp_us() */
+} link_profile_t;
+
+/**
+ * @brief Start negotiating. Call from GATT_CONNECTION_STATUS_EVT.
+ */
+void link_profile_connected(uint16_t conn_id, const wiced_bt_device_address_t bd_addr);
+
+/**
+ * @brief Forget the link. Call on disconnect.
+ */
+void link_profile_disconnected(void);
+
+/**
+ * @brief Switch between the fast and the relaxed interval. Kept across
+ * connections; due now if connected.
+ * @return true if link_profile_update() has a request to make
+ */
+bool link_profile_set_relaxed(bool relaxed);
+
+/**
+ * @brief Request the interval that is due, if any. BLE task only, on a new
+ * link and whenever another call here asked for it.
+ */
+void link_profile_update(void);
+
+/**
+ * @brief Exchange the ATT MTU. Queued by task_ble behind the CCCD write, so
+ * the gesture path is up first.
+ * @return true if a GATTC_OPTYPE_CONFIG_MTU completion will follow
+ */
+bool link_profile_request_mtu(void);
+
+/**
+ * @brief Record the MTU from the GATTC_OPTYPE_CONFIG_MTU completion.
+ */
+void link_profile_mtu_done(wiced_bt_gatt_status_t status, uint16_t mtu);
+
+/**
+ * @brief Feed management events; connection parameter, PHY and data length
+ * updates are consumed, everything else is ignored.
+ * @return true if link_profile_update() has a request to make
+ */
+bool link_profile_mgmt_event(wiced_bt_management_evt_t event, wiced_bt_management_evt_data_t *p_event_data);
+
+/**
+ * @brief Copy the negotiated values.
+ */
+void link_profile_get(link_profile_t *profile);
+
+#endif /* LINK_PROFILE_H */
@@ -19,6 +19,12 @@
 #include "cycfg_gap.h"
 #include "console.h"
 #include "timer.h"
+#include "boot_timeline.h"
+#include "timestamp.h"
+#include "link_profile.h"
+#include "link_policy.h"
+#include "gatt_cache.h"
+#include "ble_input.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -26,31 +32,153 @@
 /*******************************************************************************
 * Macros
 *******************************************************************************/
-#define TARGET_DEVICE_NAME      "Controller"    /* Name of the BLE server device to connect to */
-#define SERVER_CCCD_HANDLE      0x000E          /* Handle for Notifications (IMU) */
-#define HAPTIC_HANDLE           0x000C          /* Handle for DC Motor/Haptics */
+/* Controller GATT database, 128-bit UUIDs little endian. Handles are
+ * discovered by UUID, or taken from the EEPROM cache (gatt_cache.h) */
+#define UUID_SERVICE_SENSOR     0xAB, 0x0C, 0xE1, 0x40, 0x92, 0xA4, 0x5C, 0xA2, 0x90, 0x42, 0x25, 0x61, 0xAE, 0x44, 0xC0, 0xBB
+#define UUID_CHAR_DATA          0xD9, 0x52, 0x69, 0xA9, 0x6A, 0x53, 0x86, 0x93, 0x51, 0x40, 0xF2, 0xF5, 0xDF, 0x86, 0xDE, 0x77
+#define UUID_CHAR_COMMAND       0xC2, 0xAD, 0x4C, 0xE9, 0xAB, 0xA8, 0xD8, 0xB6, 0x16, 0x41, 0x7B, 0xB1, 0x9F, 0xF9, 0xF5, 0xFE
+
+/* Controller advertisement, manufacturer data:
+ * [company lo, hi, ADV_DATA_DB_HASH, database hash (GATT_CACHE_HASH_LEN)]
+ * Scans look for this marker rather than the device name */
+#define ADV_COMPANY_ID          0xFFFF
+#define ADV_DATA_DB_HASH        0x01
+
+/* Controller commands: [CMD_ID_MOTOR, strength, duration_ms lo, hi] and
+ * [CMD_ID_MODE, mode], the latter written after notifications are enabled */
+#define CMD_ID_MOTOR            0x01
+#define CMD_ID_MODE             0x03
 
 #define BLE_TASK_STACK_SIZE     (1024)          /* 4KB Stack */
 #define BLE_TASK_PRIORITY       (configMAX_PRIORITIES - 2) 
 
+/* GATT client operations, issued by the BLE task only. The stack allows one
+ * outstanding request (write with response, MTU exchange), so requests wait
+ * for GATT_OPERATION_CPLT_EVT. One without an answer in GATT_OP_TIMEOUT_MS
+ * still holds the stack, so the link is dropped and the connection manager
+ * starts over. Commands (write without response) need no reply and go out
+ * as soon as they are queued. Each operation owns a pool slot until
+ * GATT_APP_BUFFER_TRANSMITTED_EVT. */
+#define GATT_OP_POOL_LEN        8
+#define GATT_OP_DATA_MAX        8
+#define GATT_OP_TIMEOUT_MS      1000
+
+/* Connection manager, see conn_try(). After a link loss the controller
+ * advertises every 30 ms or so, so a direct connect to it lands within a
+ * few advertising intervals if it is on at all */
+#define CONN_DIRECT_MS          500
+#define CONN_SCAN_MS            5000    /* One scan window */
+#define CONN_CONNECT_MS         1000    /* Connect to a controller the scan found */
+#define CONN_BACKOFF_MIN_MS     200     /* Pause after an empty window, doubled each time */
+#define CONN_BACKOFF_MAX_MS     1600
+#define CONN_CACHE_WAIT_MS      1000    /* GATT cache boot job skipped: scan without it */
+
+/* BLE task notification bits */
+#define BLE_EVT_OP_QUEUED       0x01
+#define BLE_EVT_OP_DONE         0x02
+#define BLE_EVT_LINK_DOWN       0x04
+#define BLE_EVT_CACHE_SAVE      0x08
+#define BLE_EVT_STACK_UP        0x10
+#define BLE_EVT_PEER_FOUND      0x20
+#define BLE_EVT_LINK_UP         0x40
+#define BLE_EVT_SCAN_DONE       0x80
+#define BLE_EVT_LINK_PARAMS     0x100   /* See link_profile_update() */
+#define BLE_EVT_CACHE_READY     0x200   /* See task_ble_cache_ready() */
+
+typedef enum {
+    CONN_IDLE,                  /* Stack not up yet */
+    CONN_CACHE_WAIT,            /* Stack up, the GATT cache not read yet */
+    CONN_DIRECT,                /* Connecting to the remembered controller, no scan */
+    CONN_SCAN,
+    CONN_CONNECTING,            /* Connecting to what the scan found */
+    CONN_BACKOFF,
+    CONN_CONNECTED
+} conn_state_t;
+
+/* Discovery steps, one GATT request each */
+typedef enum {
+    DISCOVERY_IDLE,
+    DISCOVERY_SERVICE,
+    DISCOVERY_CHARACTERISTICS,
+    DISCOVERY_DESCRIPTORS
+} discovery_step_t;
+
+typedef enum {
+    GATT_OP_WRITE_REQ,
+    GATT_OP_WRITE_CMD,
+    GATT_OP_CONFIG_MTU,
+    GATT_OP_DISCOVER            /* handle = start, data = [type, end lo, end hi] */
+} gatt_op_type_t;
+
+typedef struct {
+    uint8_t data[GATT_OP_DATA_MAX];
+    uint32_t posted_us;         /* timestamp_us() when queued */
+    uint16_t handle;
+    uint8_t len;
+    uint8_t type;               /* gatt_op_type_t */
+    uint8_t gen;                /* gatt_op_gen when queued, see gatt_op_sent() */
+} gatt_op_t;
+
 /*******************************************************************************
 * Global Variables
 *******************************************************************************/
-/* CONTROL VARIABLE: 0=OFF, 1=ON 
- * Change this in the Debugger Watch Window to control the motor.
- */
-volatile uint8_t ble_motor_request = 1;
-
 /* Connection State */
 static volatile uint16_t connection_id = 0;
 static wiced_bt_device_address_t server_address = {0};
-static bool server_found = false;
+static wiced_bt_ble_address_type_t server_addr_type = BLE_ADDR_PUBLIC;
+
+/* Connection manager, BLE task only. The scan callback reads conn_state and
+ * the remembered controller, which do not change while a scan runs */
+static volatile conn_state_t conn_state = CONN_IDLE;
+static bool conn_timed = false;
+static TickType_t conn_deadline = 0;        /* End of the current state if conn_timed */
+static uint32_t conn_backoff_ms = CONN_BACKOFF_MIN_MS;
+static volatile bool cache_ready = false;
+static uint32_t conn_lost_us = 0;           /* Power-on, then the last link loss */
+static ble_conn_stats_t conn_stats;
+static volatile bool peer_found = false;    /* Scan matched, waiting for the task */
+static bool peer_known = false;
+static wiced_bt_device_address_t peer_address;
+static uint8_t peer_addr_type;
+static uint8_t peer_hash[GATT_CACHE_HASH_LEN];
+
+/* Database hash the controller advertised, if it did */
+static uint8_t server_db_hash[GATT_CACHE_HASH_LEN];
+static bool server_db_hash_known = false;
+
+/* Handles on the current connection, from the cache or discovery */
+static gatt_handles_t gatt_handles;
+static volatile bool handles_ready = false;
+static volatile bool handles_unverified = false;    /* From the cache, CCCD write not answered yet */
+
+/* Discovery progress, stack callback only */
+static discovery_step_t discovery_step = DISCOVERY_IDLE;
+static gatt_handles_t discovery_handles;
+static uint16_t discovery_service_start = 0;
+static uint16_t discovery_service_end = 0;
+static uint16_t discovery_data_end = 0;     /* Last handle the data characteristic's descriptors can use */
+static uint32_t discovery_started_us = 0;
 
 /* Data buffer for enabling notifications (0x01 = Enable, 0x00 = Disable) */
 static uint8_t ble_notify_enable_data[2] = {0x01, 0x00};
 
-/* Static buffer for Motor Commands to prevent memory crashes */
-static uint8_t ble_motor_cmd_buffer = 0;
+/* Report mode the Pi asked for, requested again on every connection */
+static volatile uint8_t report_mode = REPORT_MODE_DISCRETE;
+
+/* GATT operation queue, see GATT_OP_POOL_LEN */
+static TaskHandle_t ble_task_handle = NULL;
+static QueueHandle_t q_gatt_reqs = NULL;
+static QueueHandle_t q_gatt_cmds = NULL;
+static gatt_op_t gatt_op_pool[GATT_OP_POOL_LEN];
+static volatile uint32_t gatt_op_used = 0;
+static volatile uint8_t gatt_op_gen = 0;       /* Bumped on every link loss */
+static volatile uint8_t gatt_req_pending = 0;  /* GATTC_OPTYPE_x of the request in flight, 0 = none */
+static volatile wiced_bt_gatt_status_t gatt_req_status = WICED_BT_GATT_SUCCESS;
+static ble_gatt_stats_t gatt_stats;
+
+/* Haptic commands since boot, latency summed for the average */
+static ble_haptic_stats_t haptic_stats;
+static uint64_t haptic_latency_sum_us = 0;
 
 /*******************************************************************************
 * Function Prototypes
@@ -61,6 +189,26 @@ static wiced_bt_dev_status_t app_bt_management_callback(wiced_bt_management_evt_
 static wiced_bt_gatt_status_t app_gatt_callback(wiced_bt_gatt_evt_t event,
                                                 wiced_bt_gatt_event_data_t *p_data);
 static void scan_result_callback(wiced_bt_ble_scan_results_t *p_scan_result, uint8_t *p_adv_data);
+static void send_mode_cmd(void);
+static bool gatt_op_post(gatt_op_type_t type, uint16_t handle, const void *data, uint8_t len);
+static void gatt_op_free(uint8_t *buffer);
+static void gatt_op_sent(uint8_t *buffer, uint8_t gen);
+static void gatt_ops_drop(void);
+static uint8_t gatt_op_issue(uint8_t slot);
+static void gatt_session_start(void);
+static void conn_enter(conn_state_t state, uint32_t timeout_ms);
+static void conn_start(void);
+static void conn_try(void);
+static void conn_scan(void);
+static void conn_backoff(void);
+static void conn_timeout(void);
+static void conn_peer_found(void);
+static void conn_link_up(void);
+static void conn_link_down(void);
+static void discovery_start(void);
+static void discovery_post(wiced_bt_gatt_discovery_type_t type, uint16_t start, uint16_t end);
+static void discovery_result(wiced_bt_gatt_discovery_result_t *p_result);
+static void discovery_complete(wiced_bt_gatt_status_t result);
 
 /*******************************************************************************
 * Function Name: task_ble_init
@@ -69,12 +217,24 @@ void task_ble_init(void)
 {
     BaseType_t rtos_result;
 
+    q_gatt_reqs = xQueueCreate(GATT_OP_POOL_LEN, sizeof(uint8_t));
+    q_gatt_cmds = xQueueCreate(GATT_OP_POOL_LEN, sizeof(uint8_t));
+    if (q_gatt_reqs == NULL || q_gatt_cmds == NULL)
+    {
+        CY_ASSERT(0);
+    }
+
+    if (ble_input_init() != CY_RSLT_SUCCESS)
+    {
+        CY_ASSERT(0);
+    }
+
     rtos_result = xTaskCreate(ble_client_task_func, 
                               "BLE Client", 
                               BLE_TASK_STACK_SIZE, 
                               NULL, 
                               configMAX_PRIORITIES - 4, //FIx priority issue
-                              NULL);
+                              &ble_task_handle);
 
     // printf("Created BLE Client task\r\n");
     if (rtos_result != pdPASS)
@@ -85,35 +245,595 @@ void task_ble_init(void)
 }
 
 /*******************************************************************************
-* Function Name: task_ble_send_motor_cmd
+* Function Name: task_ble_haptic
+*******************************************************************************/
+bool task_ble_haptic(uint8_t strength, uint16_t duration_ms)
+{
+    uint8_t cmd[4] = {CMD_ID_MOTOR, strength, duration_ms & 0xFF, duration_ms >> 8};
+
+    haptic_stats.requested++;
+
+    if (!handles_ready)
+    {
+        haptic_stats.dropped++;
+        return false;
+    }
+
+    /* Write without response: no round trip, and it does not wait behind a request */
+    if (!gatt_op_post(GATT_OP_WRITE_CMD, gatt_handles.command_value, cmd, sizeof(cmd)))
+    {
+        haptic_stats.dropped++;
+        return false;
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: task_ble_set_report_mode
+*******************************************************************************/
+void task_ble_set_report_mode(uint8_t mode)
+{
+    report_mode = (mode == REPORT_MODE_ANALOG) ? REPORT_MODE_ANALOG : REPORT_MODE_DISCRETE;
+
+    /* Otherwise it goes out once notifications are enabled on the next connection */
+    if (handles_ready) send_mode_cmd();
+}
+
+/*******************************************************************************
+* Function Name: task_ble_cache_ready
+*******************************************************************************/
+void task_ble_cache_ready(void)
+{
+    cache_ready = true;
+    if (ble_task_handle != NULL) xTaskNotify(ble_task_handle, BLE_EVT_CACHE_READY, eSetBits);
+}
+
+/*******************************************************************************
+* Function Name: task_ble_update_link
+*******************************************************************************/
+void task_ble_update_link(void)
+{
+    xTaskNotify(ble_task_handle, BLE_EVT_LINK_PARAMS, eSetBits);
+}
+
+/*******************************************************************************
+* Function Name: send_mode_cmd
+*******************************************************************************/
+static void send_mode_cmd(void)
+{
+    uint8_t cmd[2] = {CMD_ID_MODE, report_mode};
+
+    gatt_op_post(GATT_OP_WRITE_REQ, gatt_handles.command_value, cmd, sizeof(cmd));
+}
+
+/*******************************************************************************
+* Function Name: gatt_session_start
+*
+* Handles are known: gesture path first, then the MTU, then analog mode if
+* the Pi wants it. The first connection since boot buzzes the controller.
+*******************************************************************************/
+static void gatt_session_start(void)
+{
+    static bool connected_before = false;
+
+    handles_ready = true;
+    gatt_op_post(GATT_OP_WRITE_REQ, gatt_handles.data_cccd, ble_notify_enable_data, sizeof(ble_notify_enable_data));
+    if (!connected_before)
+    {
+        connected_before = true;
+        task_ble_haptic(HAPTIC_STRENGTH_DEFAULT, HAPTIC_DURATION_DEFAULT_MS);
+    }
+    gatt_op_post(GATT_OP_CONFIG_MTU, 0, NULL, 0);
+    if (report_mode == REPORT_MODE_ANALOG) send_mode_cmd();
+}
+
+/*******************************************************************************
+* Function Name: discovery_start
+*
+* Find the sensor service, its two characteristics and the data CCCD. Each
+* step is queued as a GATT request when the previous one completes.
+*******************************************************************************/
+static void discovery_start(void)
+{
+    memset(&discovery_handles, 0, sizeof(discovery_handles));
+    discovery_service_start = 0;
+    discovery_service_end = 0;
+    discovery_started_us = timestamp_us();
+    discovery_step = DISCOVERY_SERVICE;
+    discovery_post(GATT_DISCOVER_SERVICES_BY_UUID, 0x0001, 0xFFFF);
+}
+
+/*******************************************************************************
+* Function Name: discovery_post
+*******************************************************************************/
+static void discovery_post(wiced_bt_gatt_discovery_type_t type, uint16_t start, uint16_t end)
+{
+    uint8_t data[3] = {type, end & 0xFF, end >> 8};
+
+    gatt_op_post(GATT_OP_DISCOVER, start, data, sizeof(data));
+}
+
+/*******************************************************************************
+* Function Name: discovery_result
+*******************************************************************************/
+static void discovery_result(wiced_bt_gatt_discovery_result_t *p_result)
+{
+    static const uint8_t uuid_data[LEN_UUID_128] = {UUID_CHAR_DATA};
+    static const uint8_t uuid_command[LEN_UUID_128] = {UUID_CHAR_COMMAND};
+
+    switch (discovery_step)
+    {
+        case DISCOVERY_SERVICE:
+            if (discovery_service_start == 0)
+            {
+                discovery_service_start = p_result->discovery_data.group_value.start_handle;
+                discovery_service_end = p_result->discovery_data.group_value.end_handle;
+            }
+            break;
+
+        case DISCOVERY_CHARACTERISTICS:
+        {
+            wiced_bt_gatt_char_declaration_t *p_char = &p_result->discovery_data.characteristic_declaration;
+
+            /* The declaration after the data characteristic ends its descriptors */
+            if (discovery_handles.data_value != 0 && p_char->handle > discovery_handles.data_value &&
+                p_char->handle - 1 < discovery_data_end)
+            {
+                discovery_data_end = p_char->handle - 1;
+            }
+
+            if (p_char->char_uuid.len != LEN_UUID_128) break;
+            if (memcmp(p_char->char_uuid.uu.uuid128, uuid_data, LEN_UUID_128) == 0)
+            {
+                discovery_handles.data_value = p_char->val_handle;
+            }
+            else if (memcmp(p_char->char_uuid.uu.uuid128, uuid_command, LEN_UUID_128) == 0)
+            {
+                discovery_handles.command_value = p_char->val_handle;
+            }
+            break;
+        }
+
+        case DISCOVERY_DESCRIPTORS:
+        {
+            wiced_bt_gatt_char_descr_info_t *p_descr = &p_result->discovery_data.char_descr_info;
+
+            if (discovery_handles.data_cccd == 0 && p_descr->type.len == LEN_UUID_16 &&
+                p_descr->type.uu.uuid16 == GATT_UUID_CHAR_CLIENT_CONFIG)
+            {
+                discovery_handles.data_cccd = p_descr->handle;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+/*******************************************************************************
+* Function Name: discovery_complete
+*
+* Move on to the next step. Once the CCCD is found the handles go to the
+* cache (if the controller advertised its hash) and the session starts; if
+* anything is missing the link is dropped and the next connection retries.
 *******************************************************************************/
-void task_ble_send_motor_cmd(uint8_t command)
+static void discovery_complete(wiced_bt_gatt_status_t result)
 {
-    if (connection_id == 0) return; 
+    discovery_step_t step = discovery_step;
+    bool found = false;
+
+    if (step == DISCOVERY_IDLE) return;
+    discovery_step = DISCOVERY_IDLE;
 
+    if (result == WICED_BT_GATT_SUCCESS)
+    {
+        switch (step)
+        {
+            case DISCOVERY_SERVICE:
+                if (discovery_service_start == 0) break;
+                discovery_step = DISCOVERY_CHARACTERISTICS;
+                discovery_data_end = discovery_service_end;
+                discovery_post(GATT_DISCOVER_CHARACTERISTICS, discovery_service_start, discovery_service_end);
+                return;
+
+            case DISCOVERY_CHARACTERISTICS:
+                if (discovery_handles.data_value == 0 || discovery_handles.command_value == 0 ||
+                    discovery_handles.data_value >= discovery_data_end) break;
+                discovery_step = DISCOVERY_DESCRIPTORS;
+                discovery_post(GATT_DISCOVER_CHARACTERISTIC_DESCRIPTORS, discovery_handles.data_value + 1,
+                               discovery_data_end);
+                return;
+
+            default:
+                found = (discovery_handles.data_cccd != 0);
+                break;
+        }
+    }
+
+    if (!found)
+    {
+        gatt_stats.discovery_failures++;
+        if (connection_id != 0) wiced_bt_gatt_disconnect(connection_id);
+        return;
+    }
+
+    gatt_stats.discoveries++;
+    gatt_stats.discovery_us = timestamp_us() - discovery_started_us;
+    gatt_handles = discovery_handles;
+    if (server_db_hash_known) xTaskNotify(ble_task_handle, BLE_EVT_CACHE_SAVE, eSetBits);
+    gatt_session_start();
+}
+
+/*******************************************************************************
+* Function Name: gatt_op_post
+*
+* Queue an operation for the BLE task, from any task or the stack. The data
+* is copied. Returns false if not connected or the pool is full.
+*******************************************************************************/
+static bool gatt_op_post(gatt_op_type_t type, uint16_t handle, const void *data, uint8_t len)
+{
+    QueueHandle_t queue = (type == GATT_OP_WRITE_CMD) ? q_gatt_cmds : q_gatt_reqs;
+    uint8_t slot = GATT_OP_POOL_LEN;
+
+    if (connection_id == 0 || len > GATT_OP_DATA_MAX) return false;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < GATT_OP_POOL_LEN; i++)
+    {
+        if ((gatt_op_used & (1UL << i)) == 0)
+        {
+            gatt_op_used |= (1UL << i);
+            gatt_op_pool[i].gen = gatt_op_gen;
+            slot = i;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (slot == GATT_OP_POOL_LEN)
+    {
+        gatt_stats.dropped++;
+        return false;
+    }
+
+    gatt_op_pool[slot].posted_us = timestamp_us();
+    gatt_op_pool[slot].type = type;
+    gatt_op_pool[slot].handle = handle;
+    gatt_op_pool[slot].len = len;
+    if (len > 0) memcpy(gatt_op_pool[slot].data, data, len);
+
+    if (xQueueSend(queue, &slot, 0) != pdPASS)
+    {
+        gatt_op_free(gatt_op_pool[slot].data);
+        gatt_stats.dropped++;
+        return false;
+    }
+    xTaskNotify(ble_task_handle, BLE_EVT_OP_QUEUED, eSetBits);
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: gatt_op_free
+*
+* Return a slot by its data pointer, the buffer handed to the stack.
+*******************************************************************************/
+static void gatt_op_free(uint8_t *buffer)
+{
+    for (uint8_t i = 0; i < GATT_OP_POOL_LEN; i++)
+    {
+        if (buffer == gatt_op_pool[i].data)
+        {
+            taskENTER_CRITICAL();
+            gatt_op_used &= ~(1UL << i);
+            taskEXIT_CRITICAL();
+            return;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: gatt_op_sent
+*
+* GATT_APP_BUFFER_TRANSMITTED_EVT, stack thread. gen is the slot's generation
+* when it was issued, passed as the context. A buffer from a link that has
+* since dropped can come back after gatt_ops_drop() freed its slot and a new
+* operation took it, so a stale generation is ignored. A command (haptics
+* only) has reached the link layer, which sends it on the next connection
+* event: record the latency from task_ble_haptic().
+*******************************************************************************/
+static void gatt_op_sent(uint8_t *buffer, uint8_t gen)
+{
+    for (uint8_t i = 0; i < GATT_OP_POOL_LEN; i++)
+    {
+        if (buffer == gatt_op_pool[i].data)
+        {
+            if ((gatt_op_used & (1UL << i)) == 0 || gatt_op_pool[i].gen != gen) return;
+
+            if (gatt_op_pool[i].type == GATT_OP_WRITE_CMD)
+            {
+                uint32_t latency = timestamp_us() - gatt_op_pool[i].posted_us;
+
+                haptic_stats.sent++;
+                haptic_stats.latency_last_us = latency;
+                haptic_latency_sum_us += latency;
+                haptic_stats.latency_avg_us = (uint32_t)(haptic_latency_sum_us / haptic_stats.sent);
+                if (latency > haptic_stats.latency_max_us) haptic_stats.latency_max_us = latency;
+            }
+            gatt_op_free(buffer);
+            return;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: gatt_ops_drop
+*
+* Connection lost, BLE task only: whatever is queued is for the old link.
+* The stack has released its buffers with the link, so the whole pool is
+* free again. A new generation keeps a late GATT_APP_BUFFER_TRANSMITTED_EVT
+* for the old link from freeing a slot the next one has taken.
+*******************************************************************************/
+static void gatt_ops_drop(void)
+{
+    uint8_t slot;
+
+    while (xQueueReceive(q_gatt_reqs, &slot, 0) == pdPASS) gatt_stats.dropped++;
+    while (xQueueReceive(q_gatt_cmds, &slot, 0) == pdPASS) gatt_stats.dropped++;
+
+    taskENTER_CRITICAL();
+    gatt_op_used = 0;
+    gatt_op_gen++;
+    taskEXIT_CRITICAL();
+    gatt_req_pending = 0;
+}
+
+/*******************************************************************************
+* Function Name: gatt_op_issue
+*
+* Hand an operation to the stack, BLE task only. Returns the GATTC_OPTYPE_x
+* of the GATT_OPERATION_CPLT_EVT to wait for, 0 if none will follow.
+*******************************************************************************/
+static uint8_t gatt_op_issue(uint8_t slot)
+{
+    gatt_op_t *op = &gatt_op_pool[slot];
     wiced_bt_gatt_write_hdr_t write_hdr;
+    wiced_bt_gatt_status_t status;
+    uint8_t completion = 0;
 
-    /* Update the static buffer */
-    ble_motor_cmd_buffer = command;
+    gatt_stats.issued++;
+
+    /* Set before sending, the completion can arrive before the call returns */
+    if (op->type == GATT_OP_CONFIG_MTU)
+    {
+        gatt_op_free(op->data);
+        gatt_req_pending = GATTC_OPTYPE_CONFIG_MTU;
+        if (link_profile_request_mtu()) return GATTC_OPTYPE_CONFIG_MTU;
+        gatt_req_pending = 0;
+        return 0;
+    }
+    if (op->type == GATT_OP_DISCOVER)
+    {
+        wiced_bt_gatt_discovery_type_t type = (wiced_bt_gatt_discovery_type_t)op->data[0];
+        wiced_bt_gatt_discovery_param_t param;
+        static const uint8_t uuid_service[LEN_UUID_128] = {UUID_SERVICE_SENSOR};
+
+        memset(&param, 0, sizeof(param));
+        param.s_handle = op->handle;
+        param.e_handle = op->data[1] | (op->data[2] << 8);
+        if (type == GATT_DISCOVER_SERVICES_BY_UUID)
+        {
+            param.service_type.len = LEN_UUID_128;
+            memcpy(param.service_type.uu.uuid128, uuid_service, LEN_UUID_128);
+        }
+        gatt_op_free(op->data);
+
+        /* Completes with GATT_DISCOVERY_CPLT_EVT, tracked as GATTC_OPTYPE_DISCOVERY */
+        gatt_req_pending = GATTC_OPTYPE_DISCOVERY;
+        if (wiced_bt_gatt_client_send_discover(connection_id, type, &param) == WICED_BT_GATT_SUCCESS)
+        {
+            return GATTC_OPTYPE_DISCOVERY;
+        }
+        gatt_req_pending = 0;
+        gatt_stats.failed++;
+        discovery_complete(WICED_BT_GATT_ERROR);
+        return 0;
+    }
+    if (op->type == GATT_OP_WRITE_REQ)
+    {
+        completion = GATTC_OPTYPE_WRITE_WITH_RSP;
+        gatt_req_pending = completion;
+    }
 
     memset(&write_hdr, 0, sizeof(write_hdr));
-    write_hdr.handle = HAPTIC_HANDLE;
-    write_hdr.len = 1;
-    write_hdr.offset = 0;
+    write_hdr.handle = op->handle;
+    write_hdr.len = op->len;
     write_hdr.auth_req = GATT_AUTH_REQ_NONE;
 
-    /* Send Write Request */
-    wiced_bt_gatt_status_t status = wiced_bt_gatt_client_send_write(
-        connection_id, 
-        GATT_REQ_WRITE, 
-        &write_hdr, 
-        &ble_motor_cmd_buffer, 
-        NULL 
-    );
-
+    status = wiced_bt_gatt_client_send_write(connection_id,
+                                             (op->type == GATT_OP_WRITE_CMD) ? GATT_CMD_WRITE : GATT_REQ_WRITE,
+                                             &write_hdr, op->data, (void *)(uintptr_t)op->gen);
     if (status != WICED_BT_GATT_SUCCESS)
     {
-        // printf("Failed to send motor command. Status: %d\r\n", status);
+        gatt_op_free(op->data);
+        gatt_stats.failed++;
+        if (completion != 0) gatt_req_pending = 0;
+        return 0;
+    }
+    return completion;
+}
+
+/*******************************************************************************
+* Function Name: conn_enter
+*
+* Connection manager state change, BLE task only. The state ends after
+* timeout_ms (0 = never) with conn_timeout(), run from the task loop.
+*******************************************************************************/
+static void conn_enter(conn_state_t state, uint32_t timeout_ms)
+{
+    conn_state = state;
+    conn_timed = (timeout_ms != 0);
+    conn_deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
+}
+
+/*******************************************************************************
+* Function Name: conn_start
+*
+* First connection cycle after the stack is up and the GATT cache is read.
+*******************************************************************************/
+static void conn_start(void)
+{
+    conn_try();
+    boot_mark((conn_state == CONN_DIRECT) ? "ble direct connect" : "ble scanning");
+}
+
+/*******************************************************************************
+* Function Name: conn_try
+*
+* Start a connection cycle: straight to the remembered controller if there
+* is one (no scan, and the link layer filters on its address), then a scan
+* window, then a backoff before the next cycle.
+*******************************************************************************/
+static void conn_try(void)
+{
+    peer_known = gatt_cache_peer(peer_address, &peer_addr_type, peer_hash);
+    if (!peer_known)
+    {
+        conn_scan();
+        return;
+    }
+
+    memcpy(server_address, peer_address, BD_ADDR_LEN);
+    server_addr_type = (wiced_bt_ble_address_type_t)peer_addr_type;
+    memcpy(server_db_hash, peer_hash, GATT_CACHE_HASH_LEN);
+    server_db_hash_known = true;
+
+    conn_enter(CONN_DIRECT, CONN_DIRECT_MS);
+    if (!wiced_bt_gatt_le_connect(server_address, server_addr_type, BLE_CONN_MODE_HIGH_DUTY, WICED_TRUE))
+    {
+        conn_scan();
+    }
+}
+
+/*******************************************************************************
+* Function Name: conn_scan
+*******************************************************************************/
+static void conn_scan(void)
+{
+    peer_found = false;
+    conn_stats.scans++;
+    conn_enter(CONN_SCAN, CONN_SCAN_MS);
+    wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_HIGH_DUTY, WICED_TRUE, scan_result_callback);
+}
+
+/*******************************************************************************
+* Function Name: conn_backoff
+*******************************************************************************/
+static void conn_backoff(void)
+{
+    conn_stats.backoffs++;
+    conn_enter(CONN_BACKOFF, conn_backoff_ms);
+    conn_backoff_ms = (conn_backoff_ms * 2 < CONN_BACKOFF_MAX_MS) ? conn_backoff_ms * 2 : CONN_BACKOFF_MAX_MS;
+}
+
+/*******************************************************************************
+* Function Name: conn_timeout
+*******************************************************************************/
+static void conn_timeout(void)
+{
+    switch (conn_state)
+    {
+        case CONN_DIRECT:
+            /* Off or out of range: it may have a new address, so scan */
+            conn_stats.direct_timeouts++;
+            wiced_bt_gatt_cancel_connect(server_address, WICED_TRUE);
+            conn_scan();
+            break;
+
+        case CONN_SCAN:
+            conn_backoff();
+            wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_NONE, WICED_TRUE, scan_result_callback);
+            break;
+
+        case CONN_CONNECTING:
+            wiced_bt_gatt_cancel_connect(server_address, WICED_TRUE);
+            conn_backoff();
+            break;
+
+        case CONN_BACKOFF:
+            conn_try();
+            break;
+
+        case CONN_CACHE_WAIT:
+            conn_start();
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*******************************************************************************
+* Function Name: conn_peer_found
+*******************************************************************************/
+static void conn_peer_found(void)
+{
+    if (conn_state != CONN_SCAN) return;
+
+    conn_enter(CONN_CONNECTING, CONN_CONNECT_MS);
+    wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_NONE, WICED_TRUE, scan_result_callback);
+    if (!wiced_bt_gatt_le_connect(server_address, server_addr_type, BLE_CONN_MODE_HIGH_DUTY, WICED_TRUE))
+    {
+        conn_backoff();
+    }
+}
+
+/*******************************************************************************
+* Function Name: conn_link_up
+*
+* Also taken from a state that just timed out, the connect can win the race
+* with its cancel.
+*******************************************************************************/
+static void conn_link_up(void)
+{
+    uint32_t restore_us = timestamp_us() - conn_lost_us;
+    conn_state_t state = conn_state;
+
+    conn_enter(CONN_CONNECTED, 0);
+    if (state == CONN_SCAN) wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_NONE, WICED_TRUE, scan_result_callback);
+
+    conn_backoff_ms = CONN_BACKOFF_MIN_MS;
+    conn_stats.connects++;
+    if (state == CONN_DIRECT) conn_stats.direct++;
+    conn_stats.restore_us = restore_us;
+    if (restore_us > conn_stats.restore_max_us) conn_stats.restore_max_us = restore_us;
+}
+
+/*******************************************************************************
+* Function Name: conn_link_down
+*
+* A lost link, or a connect that failed instead of timing out.
+*******************************************************************************/
+static void conn_link_down(void)
+{
+    switch (conn_state)
+    {
+        case CONN_CONNECTED:
+            conn_lost_us = timestamp_us();
+            conn_try();
+            break;
+
+        case CONN_DIRECT:
+            conn_stats.direct_timeouts++;
+            conn_scan();
+            break;
+
+        case CONN_CONNECTING:
+            conn_backoff();
+            break;
+
+        default:
+            break;
     }
 }
 
@@ -124,10 +844,19 @@ static void ble_client_task_func(void *arg)
 {
     (void)arg;
     cy_rslt_t result;
-    uint8_t current_request_state = 0;
-    uint8_t last_request_state = 0;
+    uint8_t req_in_flight = 0;
+    bool req_stalled = false;       /* Timed out, nothing more until the link is down */
+    TickType_t req_started = 0;
+    uint32_t events;
+    uint8_t slot;
     
     // printf("BLE Client task started\r\n");
+    boot_mark("ble task");
+
+    if (link_policy_init() != CY_RSLT_SUCCESS)
+    {
+        CY_ASSERT(0);
+    }
     
     /* Initialize platform specific Bluetooth configuration */
     cybt_platform_config_init(&cybsp_bt_platform_cfg);
@@ -142,19 +871,98 @@ static void ble_client_task_func(void *arg)
     
     for(;;)
     {
-        current_request_state = ble_motor_request;
+        TickType_t wait = portMAX_DELAY;
 
-        /* Check if the variable has changed */
-        if (current_request_state != last_request_state)
+        /* Nothing to poll: wake on queued operations and completions, or
+           when the request in flight or the connection state times out */
+        if (req_in_flight != 0)
         {
-            if (connection_id != 0)
-            {
-                // printf("Sending Motor Command: %d\r\n", current_request_state);
-                task_ble_send_motor_cmd(current_request_state);
-                last_request_state = current_request_state;
-            }
+            TickType_t elapsed = xTaskGetTickCount() - req_started;
+            wait = (elapsed < pdMS_TO_TICKS(GATT_OP_TIMEOUT_MS)) ?
+                   pdMS_TO_TICKS(GATT_OP_TIMEOUT_MS) - elapsed : 0;
+        }
+        if (conn_timed)
+        {
+            TickType_t left = conn_deadline - xTaskGetTickCount();
+            if ((int32_t)left < 0) left = 0;
+            if (left < wait) wait = left;
+        }
+
+        events = 0;
+        xTaskNotifyWait(0, 0xFFFFFFFF, &events, wait);
+
+        if (events & BLE_EVT_STACK_UP)
+        {
+            /* The controller to connect to straight away is in the GATT
+               cache, which a boot job may still be reading */
+            if (cache_ready) conn_start();
+            else conn_enter(CONN_CACHE_WAIT, CONN_CACHE_WAIT_MS);
+        }
+        if ((events & BLE_EVT_CACHE_READY) && conn_state == CONN_CACHE_WAIT)
+        {
+            conn_start();
+        }
+        if (events & BLE_EVT_PEER_FOUND)
+        {
+            conn_peer_found();
+        }
+        if (events & BLE_EVT_LINK_UP)
+        {
+            conn_link_up();
+        }
+        if (events & (BLE_EVT_LINK_UP | BLE_EVT_LINK_PARAMS))
+        {
+            link_profile_update();
+        }
+        if (events & BLE_EVT_LINK_DOWN)
+        {
+            /* Only this task reconnects, so nothing is queued for a new link yet */
+            gatt_ops_drop();
+            req_in_flight = 0;
+            req_stalled = false;
+            conn_link_down();
+        }
+        if ((events & BLE_EVT_SCAN_DONE) && conn_state == CONN_SCAN)
+        {
+            /* The stack ended the window early */
+            conn_backoff();
+        }
+        if (conn_timed && (int32_t)(xTaskGetTickCount() - conn_deadline) >= 0)
+        {
+            conn_timed = false;
+            conn_timeout();
+        }
+        if (events & BLE_EVT_CACHE_SAVE)
+        {
+            /* Not in the stack callback; the EEPROM write happens elsewhere */
+            gatt_cache_store(server_address, server_addr_type, server_db_hash, &gatt_handles);
+        }
+        if ((events & BLE_EVT_OP_DONE) && req_in_flight != 0)
+        {
+            if (gatt_req_status == WICED_BT_GATT_SUCCESS) gatt_stats.completed++;
+            else gatt_stats.failed++;
+            req_in_flight = 0;
+        }
+        if (req_in_flight != 0 && xTaskGetTickCount() - req_started >= pdMS_TO_TICKS(GATT_OP_TIMEOUT_MS))
+        {
+            /* The stack still holds it and would refuse the next request:
+               drop the link, BLE_EVT_LINK_DOWN cleans up and reconnects */
+            gatt_stats.timeouts++;
+            gatt_req_pending = 0;
+            req_in_flight = 0;
+            req_stalled = true;
+            if (connection_id != 0) wiced_bt_gatt_disconnect(connection_id);
+        }
+
+        while (xQueueReceive(q_gatt_cmds, &slot, 0) == pdPASS)
+        {
+            gatt_op_issue(slot);
+        }
+        while (req_in_flight == 0 && !req_stalled && xQueueReceive(q_gatt_reqs, &slot, 0) == pdPASS)
+        {
+            req_in_flight = gatt_op_issue(slot);
+            req_started = xTaskGetTickCount();
         }
-        vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
 
@@ -173,20 +981,53 @@ static wiced_bt_dev_status_t app_bt_management_callback(wiced_bt_management_evt_
             // printf("Bluetooth Enabled\r\n");
             wiced_bt_dev_read_local_addr(bda);
             wiced_bt_gatt_register(app_gatt_callback);
-            // printf("Scanning for '%s'...\r\n", TARGET_DEVICE_NAME);
-            wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_HIGH_DUTY, WICED_TRUE, scan_result_callback);
+            boot_mark("ble stack enabled");
+            xTaskNotify(ble_task_handle, BLE_EVT_STACK_UP, eSetBits);
             break;
 
         case BTM_DISABLED_EVT:
             // printf("Bluetooth Disabled\r\n");
             break;
 
+        /* The controller bonds to learn this console's identity and direct its
+           advertising here after a link loss. Just Works; no attribute needs
+           encryption, so the console keeps no keys and a reconnect does not
+           wait for it */
+        case BTM_PAIRING_IO_CAPABILITIES_BLE_REQUEST_EVT:
+            p_event_data->pairing_io_capabilities_ble_request.local_io_cap = BTM_IO_CAPABILITIES_NONE;
+            p_event_data->pairing_io_capabilities_ble_request.oob_data = BTM_OOB_NONE;
+            p_event_data->pairing_io_capabilities_ble_request.auth_req = BTM_LE_AUTH_REQ_BOND;
+            p_event_data->pairing_io_capabilities_ble_request.max_key_size = 16;
+            p_event_data->pairing_io_capabilities_ble_request.init_keys = BTM_LE_KEY_PENC | BTM_LE_KEY_PID;
+            p_event_data->pairing_io_capabilities_ble_request.resp_keys = BTM_LE_KEY_PENC | BTM_LE_KEY_PID;
+            break;
+
+        case BTM_SECURITY_REQUEST_EVT:
+            wiced_bt_ble_security_grant(p_event_data->security_request.bd_addr, WICED_BT_SUCCESS);
+            break;
+
         case BTM_PAIRED_DEVICE_LINK_KEYS_UPDATE_EVT:
             break;
 
+        case BTM_PAIRED_DEVICE_LINK_KEYS_REQUEST_EVT:
+        case BTM_LOCAL_IDENTITY_KEYS_REQUEST_EVT:
+            status = WICED_BT_ERROR;
+            break;
+
         case BTM_BLE_SCAN_STATE_CHANGED_EVT:
             break;
 
+        case BTM_BLE_CONNECTION_PARAM_UPDATE:
+            if (link_profile_mgmt_event(event, p_event_data)) task_ble_update_link();
+            link_policy_link_updated(p_event_data->ble_connection_param_update.status,
+                                     p_event_data->ble_connection_param_update.conn_interval);
+            break;
+
+        case BTM_BLE_PHY_UPDATE_EVT:
+        case BTM_BLE_DATA_LENGTH_UPDATE_EVENT:
+            if (link_profile_mgmt_event(event, p_event_data)) task_ble_update_link();
+            break;
+
         default:
             // printf("BT Event: 0x%x\r\n", event);
             break;
@@ -197,36 +1038,40 @@ static wiced_bt_dev_status_t app_bt_management_callback(wiced_bt_management_evt_
 
 /*******************************************************************************
 * Function Name: scan_result_callback
+*
+* Stack thread: match and hand over to the BLE task, which stops the scan
+* and connects. The remembered controller matches on its address (directed
+* advertising carries no data at all), any other on the manufacturer data
+* marker.
 *******************************************************************************/
 static void scan_result_callback(wiced_bt_ble_scan_results_t *p_scan_result, uint8_t *p_adv_data)
 {
     uint8_t len = 0;
-    uint8_t *p_name = NULL;
-    
+    uint8_t *p_mfr = NULL;
+    bool known;
+    bool marked;
+
+    if (conn_state != CONN_SCAN || peer_found) return;
+
     if (p_scan_result == NULL)
     {
-        if (!server_found)
-        {
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_HIGH_DUTY, WICED_TRUE, scan_result_callback);
-        }
+        xTaskNotify(ble_task_handle, BLE_EVT_SCAN_DONE, eSetBits);
         return;
     }
-    
-    p_name = wiced_bt_ble_check_advertising_data(p_adv_data, BTM_BLE_ADVERT_TYPE_NAME_COMPLETE, &len);
-    if (!p_name) p_name = wiced_bt_ble_check_advertising_data(p_adv_data, BTM_BLE_ADVERT_TYPE_NAME_SHORT, &len);
-    
-    if (p_name != NULL)
-    {
-        if (len == strlen(TARGET_DEVICE_NAME) && memcmp(p_name, TARGET_DEVICE_NAME, len) == 0)
-        {
-            // printf("Target found. Connecting...\r\n");
-            server_found = true;
-            memcpy(server_address, p_scan_result->remote_bd_addr, BD_ADDR_LEN);
-            wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_NONE, WICED_TRUE, scan_result_callback);
-            wiced_bt_gatt_le_connect(server_address, p_scan_result->ble_addr_type, BLE_CONN_MODE_HIGH_DUTY, WICED_TRUE);
-        }
-    }
+
+    known = peer_known && memcmp(p_scan_result->remote_bd_addr, peer_address, BD_ADDR_LEN) == 0;
+    p_mfr = wiced_bt_ble_check_advertising_data(p_adv_data, BTM_BLE_ADVERT_TYPE_MANUFACTURER, &len);
+    marked = (p_mfr != NULL && len == 3 + GATT_CACHE_HASH_LEN &&
+              (p_mfr[0] | (p_mfr[1] << 8)) == ADV_COMPANY_ID && p_mfr[2] == ADV_DATA_DB_HASH);
+    if (!known && !marked) return;
+
+    memcpy(server_address, p_scan_result->remote_bd_addr, BD_ADDR_LEN);
+    server_addr_type = p_scan_result->ble_addr_type;
+    server_db_hash_known = true;
+    memcpy(server_db_hash, marked ? &p_mfr[3] : peer_hash, GATT_CACHE_HASH_LEN);
+
+    peer_found = true;
+    xTaskNotify(ble_task_handle, BLE_EVT_PEER_FOUND, eSetBits);
 }
 
 /*******************************************************************************
@@ -244,16 +1089,25 @@ static wiced_bt_gatt_status_t app_gatt_callback(wiced_bt_gatt_evt_t event,
             if (p_data->connection_status.connected)
             {
                 connection_id = p_data->connection_status.conn_id;
+                boot_mark("ble connected");
+                xTaskNotify(ble_task_handle, BLE_EVT_LINK_UP, eSetBits);
+                ble_input_connected();
+                link_profile_connected(connection_id, p_data->connection_status.bd_addr);
                 // printf("Connected (ID: %d). Enabling Notifications...\r\n", connection_id);
                 xEventGroupSetBits(wall_event, CONNECTION_EVENT_BIT);//daksh change- connection sound
 
-                wiced_bt_gatt_write_hdr_t write_hdr;
-                memset(&write_hdr, 0, sizeof(write_hdr));
-                write_hdr.handle    = SERVER_CCCD_HANDLE;
-                write_hdr.len       = 2;
-                write_hdr.auth_req  = GATT_AUTH_REQ_NONE;
-
-                wiced_bt_gatt_client_send_write(connection_id, GATT_REQ_WRITE, &write_hdr, ble_notify_enable_data, NULL);
+                /* Same database as last time: no discovery round trips */
+                if (server_db_hash_known &&
+                    gatt_cache_lookup(p_data->connection_status.bd_addr, server_db_hash, &gatt_handles))
+                {
+                    gatt_stats.cache_hits++;
+                    handles_unverified = true;
+                    gatt_session_start();
+                }
+                else
+                {
+                    discovery_start();
+                }
                 if (!timer_started)
                 {
                     // printf("Starting timer...\r\n");
@@ -265,81 +1119,69 @@ static wiced_bt_gatt_status_t app_gatt_callback(wiced_bt_gatt_evt_t event,
             {
                 // printf("Disconnected (%d). Restarting scan...\r\n", p_data->connection_status.reason);
                 connection_id = 0;
-                server_found = false;
-                wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_HIGH_DUTY, WICED_TRUE, scan_result_callback);
+                handles_ready = false;
+                handles_unverified = false;
+                discovery_step = DISCOVERY_IDLE;
+                link_profile_disconnected();
+                xTaskNotify(ble_task_handle, BLE_EVT_LINK_DOWN, eSetBits);
             }
             break;
 
         case GATT_OPERATION_CPLT_EVT:
-            
-            /* Check for Incoming Notifications */
-            if (p_data->operation_complete.op == GATTC_OPTYPE_NOTIFICATION)
+
+            if (p_data->operation_complete.op == GATTC_OPTYPE_CONFIG_MTU)
+            {
+                link_profile_mtu_done(p_data->operation_complete.status, p_data->operation_complete.response_data.mtu);
+            }
+
+            /* The first request on cached handles is the CCCD write. Refused,
+               the database changed without the hash: discover it on this link.
+               The hash stays known, so the new handles replace the stale ones
+               in the cache instead of being tried again on every connection */
+            if (p_data->operation_complete.op == GATTC_OPTYPE_WRITE_WITH_RSP && handles_unverified)
             {
-                wiced_bt_gatt_data_t *p_notif = &p_data->operation_complete.response_data.att_value;
-                
-                /* CHANGED: Accept any length >= 1 byte */
-                if (p_notif->p_data != NULL && p_notif->len >= 1)
+                handles_unverified = false;
+                if (p_data->operation_complete.status != WICED_BT_GATT_SUCCESS)
                 {
-                    uint8_t gesture = p_notif->p_data[0];
-
-                    static uint8_t left_count = 0;
-                    static uint8_t right_count = 0;
-                    static uint8_t up_count = 0;
-                    static uint8_t down_count = 0;
-                    int MOVE_THRESHOLD = 1;
-                    switch (gesture)
-                    {
-                        case 0x01:  
-                        left_count++;
-                        if (left_count >= MOVE_THRESHOLD) {
-                            uart_send_string("LEFT\n");
-                            // printf("Move: LEFT\r\n");
-                            left_count = 0;
-                        }
-                        right_count = 0;
-                        up_count = 0;
-                        down_count = 0;
-                        break;
-                        case 0x02:
-                        right_count++;
-                        if (right_count >= MOVE_THRESHOLD) {
-                            // printf("Move: RIGHT\r\n"); 
-                            uart_send_string("RIGHT\n");
-                            right_count = 0;
-                        }
-                        left_count = 0;
-                        up_count = 0;
-                        down_count = 0;
-                        break;
-                        case 0x03: 
-                        up_count++;
-                        if (up_count >= MOVE_THRESHOLD) {
-                            // printf("Move: UP\r\n"); 
-                            uart_send_string("UP\n");
-                            up_count = 0;
-                        }
-                        left_count = 0;
-                        right_count = 0;
-                        down_count = 0;
-                        break;
-                        case 0x04: 
-                        down_count++;
-                        if (down_count >= MOVE_THRESHOLD) {
-                            // printf("Move: DOWN\r\n");
-                            uart_send_string("DOWN\n"); 
-                            down_count = 0;
-                        }
-                        left_count = 0;
-                        right_count = 0;
-                        up_count = 0;
-                        break;
-                        case 0x00: 
-                        // printf("Idle\r\n"); 
-                        break;
-                        default:   break;
-                    }
+                    gatt_stats.cache_stale++;
+                    handles_ready = false;
+                    discovery_start();
                 }
             }
+
+            /* The request in flight is done, the BLE task sends the next one */
+            if (gatt_req_pending != 0 && p_data->operation_complete.op == gatt_req_pending)
+            {
+                gatt_req_pending = 0;
+                gatt_req_status = p_data->operation_complete.status;
+                xTaskNotify(ble_task_handle, BLE_EVT_OP_DONE, eSetBits);
+            }
+
+            /* Incoming notification: copied for the input task, decoded there */
+            if (p_data->operation_complete.op == GATTC_OPTYPE_NOTIFICATION &&
+                p_data->operation_complete.response_data.att_value.handle == gatt_handles.data_value)
+            {
+                ble_input_notify(p_data->operation_complete.response_data.att_value.p_data,
+                                 p_data->operation_complete.response_data.att_value.len);
+            }
+            break;
+
+        case GATT_DISCOVERY_RESULT_EVT:
+            discovery_result(&p_data->discovery_result);
+            break;
+
+        case GATT_DISCOVERY_CPLT_EVT:
+            if (gatt_req_pending == GATTC_OPTYPE_DISCOVERY)
+            {
+                gatt_req_pending = 0;
+                gatt_req_status = p_data->discovery_complete.status;
+                xTaskNotify(ble_task_handle, BLE_EVT_OP_DONE, eSetBits);
+            }
+            discovery_complete(p_data->discovery_complete.status);
+            break;
+
+        case GATT_APP_BUFFER_TRANSMITTED_EVT:
+            gatt_op_sent(p_data->buffer_xmitted.p_app_data, (uint8_t)(uintptr_t)p_data->buffer_xmitted.p_app_ctxt);
             break;
 
         default:
@@ -348,3 +1190,27 @@ static wiced_bt_gatt_status_t app_gatt_callback(wiced_bt_gatt_evt_t event,
 
     return status;
 }
+
+/*******************************************************************************
+* Function Name: task_ble_get_gatt_stats
+*******************************************************************************/
+void task_ble_get_gatt_stats(ble_gatt_stats_t *stats)
+{
+    *stats = gatt_stats;
+}
+
+/*******************************************************************************
+* Function Name: task_ble_get_conn_stats
+*******************************************************************************/
+void task_ble_get_conn_stats(ble_conn_stats_t *stats)
+{
+    *stats = conn_stats;
+}
+
+/*******************************************************************************
+* Function Name: task_ble_get_haptic_stats
+*******************************************************************************/
+void task_ble_get_haptic_stats(ble_haptic_stats_t *stats)
+{
+    *stats = haptic_stats;
+}
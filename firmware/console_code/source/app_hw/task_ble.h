@@ -32,14 +32,91 @@
  */
 void task_ble_init(void);
 
+/* Same pulse the controller gives for the legacy 1-byte command */
+#define HAPTIC_STRENGTH_DEFAULT     100     /* Motor duty, percent */
+#define HAPTIC_DURATION_DEFAULT_MS  500
+
+/**
+ * @brief Pulse the controller motor. Safe from any task: the command is
+ * queued to the BLE task and written without response, so it goes out on
+ * the next connection event.
+ * @return false if not connected or the queue is full
+ */
+bool task_ble_haptic(uint8_t strength, uint16_t duration_ms);
+
+/* Haptic commands since boot. Latency runs from task_ble_haptic() to the
+ * stack handing the write to the link layer */
+typedef struct {
+    uint32_t requested;
+    uint32_t sent;
+    uint32_t dropped;           /* Not connected, or no room in the queue */
+    uint32_t latency_avg_us;
+    uint32_t latency_max_us;
+    uint32_t latency_last_us;
+} ble_haptic_stats_t;
+
 /**
- * @brief Sends a command to the Motor/Haptic characteristic.
+ * @brief Copy the haptic command counters.
  */
-void task_ble_send_motor_cmd(uint8_t command);
+void task_ble_get_haptic_stats(ble_haptic_stats_t *stats);
+
+/* Report modes, requested from the controller at connect time */
+#define REPORT_MODE_DISCRETE    0x00    /* 1-byte gestures only (default) */
+#define REPORT_MODE_ANALOG      0x01    /* Gestures plus int8 roll/pitch at the IMU rate */
 
-/* * EXTERN DECLARATION
- * This allows other files (like console.c) to modify the motor request.
+/**
+ * @brief Select the report mode, sent now if connected and on every reconnect.
+ */
+void task_ble_set_report_mode(uint8_t mode);
+
+/**
+ * @brief The GATT cache has been read, so the first connection can go
+ * straight to the remembered controller. Until then the BLE task holds off
+ * connecting, for up to a second. Safe from any task.
+ */
+void task_ble_cache_ready(void);
+
+/**
+ * @brief Wake the BLE task to request the connection interval that
+ * link_profile.h says is due. Safe from any task or the stack.
+ */
+void task_ble_update_link(void);
+
+/* GATT client operations since boot (see task_ble.c) */
+typedef struct {
+    uint32_t issued;            /* Handed to the stack */
+    uint32_t completed;         /* Requests answered with success */
+    uint32_t failed;            /* Refused by the stack or answered with an error */
+    uint32_t timeouts;          /* Requests with no answer in time */
+    uint32_t dropped;           /* Pool or queue full, or the link went down first */
+    uint32_t cache_hits;        /* Connections that used the cached handles */
+    uint32_t discoveries;       /* Connections that discovered them */
+    uint32_t discovery_failures;
+    uint32_t discovery_us;      /* Duration of the last discovery */
+    uint32_t cache_stale;       /* Cached handles the controller refused, discovered again */
+} ble_gatt_stats_t;
+
+/**
+ * @brief Copy the GATT operation counters.
+ */
+void task_ble_get_gatt_stats(ble_gatt_stats_t *stats);
+
+/* Connection manager since boot. Restore time runs from power-on or the
+ * link loss to the next connection, so it includes any time the controller
+ * was off */
+typedef struct {
+    uint32_t connects;
+    uint32_t direct;            /* Connections made without a scan, to the remembered controller */
+    uint32_t direct_timeouts;   /* Direct attempts it did not answer */
+    uint32_t scans;             /* Scan windows started */
+    uint32_t backoffs;          /* Scan windows or connects that found nothing */
+    uint32_t restore_us;        /* Last restore time */
+    uint32_t restore_max_us;
+} ble_conn_stats_t;
+
+/**
+ * @brief Copy the connection manager counters.
  */
-extern volatile uint8_t ble_motor_request;
+void task_ble_get_conn_stats(ble_conn_stats_t *stats);
 
-#endif /* TASK_BLE_H */
\ No newline at end of file
+#endif /* TASK_BLE_H */
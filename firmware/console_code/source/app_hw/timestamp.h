@@ -0,0 +1,25 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include "main.h"
+
+/*
+ * Free-running 1 MHz hardware timer (32-bit TCPWM counter) used as a
+ * monotonic microsecond clock. It wraps every ~71 minutes, so compare
+ * stamps by unsigned subtraction: (uint32_t)(b - a).
+ */
+
+#define TIMESTAMP_FREQ_HZ       1000000u
+
+/**
+ * @brief Start the counter. Call once from main before the scheduler starts.
+ * @return An error if the only free counter is 16-bit
+ */
+cy_rslt_t timestamp_init(void);
+
+/**
+ * @brief Microseconds since timestamp_init(), 0 if it never ran. ISR safe.
+ */
+uint32_t timestamp_us(void);
+
+#endif /* TIMESTAMP_H */
@@ -13,58 +13,261 @@ const cyhal_uart_cfg_t uart_config =
     .rx_buffer_size = 0
 };
 
-QueueHandle_t q_uart_rx = NULL;
-QueueHandle_t q_uart_tx = NULL;
-
 TaskHandle_t Task_UART_Rx_Handle = NULL;
 
-static uint8_t uart_rx_buffer[UART_RX_BUFFER];
-static uint16_t uart_rx_index = 0;
-
 static uart_rx_callback_t rx_callback = NULL;
 
+/*
+ * Receive line buffers. Whoever reads the FIFO frames bytes straight into
+ * rx_lines[rx_head] and moves rx_head on at the newline; the RX task hands
+ * rx_lines[rx_tail] to the callback in place and moves rx_tail on after.
+ * The FIFO is read by the interrupt, or by the task with the interrupt
+ * held off, so there is one writer at a time. Both counters wrap.
+ */
+static uint8_t rx_lines[UART_RX_LINES][UART_RX_BUFFER + 1];   /* Plus the terminator */
+static uint16_t rx_length[UART_RX_LINES];
+static volatile uint8_t rx_head = 0;
+static volatile uint8_t rx_tail = 0;
+static uint16_t rx_fill = 0;            /* Bytes so far in rx_lines[rx_head] */
+static bool rx_discard = false;         /* Dropping up to the next newline */
+
+static uart_rx_stats_t rx_stats;
+
+/*
+ * Transmit ring. Producers copy in and move tx_head inside a critical
+ * section, which also holds off the UART interrupt; the interrupt moves
+ * tx_tail once the HAL has sent a run. Both count up and wrap, so
+ * tx_head - tx_tail is always the number of bytes waiting. The HAL reads
+ * straight out of the ring, so the tx_inflight bytes past tx_tail are not
+ * free until the transfer is done.
+ */
+static uint8_t tx_ring[UART_TX_RING];
+static volatile uint32_t tx_head = 0;
+static volatile uint32_t tx_tail = 0;
+static volatile uint16_t tx_inflight = 0;
+
+/* Given from the interrupt whenever room frees up, for uart_printf */
+static SemaphoreHandle_t tx_space = NULL;
+
+static uart_tx_stats_t tx_stats;
+
+/* Helper: Start the HAL on the longest contiguous run from tx_tail. Called
+   with the UART interrupt held off, or from it */
+static void tx_start(void)
+{
+    uint32_t waiting = tx_head - tx_tail;
+    uint32_t index = tx_tail & (UART_TX_RING - 1);
+    uint32_t run;
+
+    if (tx_inflight != 0 || waiting == 0)
+    {
+        return;
+    }
+
+    run = UART_TX_RING - index;
+    if (run > waiting)
+    {
+        run = waiting;
+    }
+
+    /* On failure nothing is in flight and the next send tries again */
+    if (cyhal_uart_write_async(&uart_obj, &tx_ring[index], run) == CY_RSLT_SUCCESS)
+    {
+        tx_inflight = (uint16_t)run;
+    }
+}
+
+/* Helper: Copy a whole message into the ring, or nothing if it does not fit */
+static BaseType_t tx_put(const uint8_t *data, uint16_t length)
+{
+    uint32_t index;
+    uint32_t first;
+    uint32_t waiting;
+
+    taskENTER_CRITICAL();
+
+    if (UART_TX_RING - (tx_head - tx_tail) < length)
+    {
+        /* In case the last start failed */
+        tx_start();
+        taskEXIT_CRITICAL();
+        return pdFAIL;
+    }
+
+    index = tx_head & (UART_TX_RING - 1);
+    first = UART_TX_RING - index;
+    if (first > length)
+    {
+        first = length;
+    }
+    memcpy(&tx_ring[index], data, first);
+    memcpy(tx_ring, data + first, length - first);
+    tx_head += length;
+
+    waiting = tx_head - tx_tail;
+    if (waiting > tx_stats.high_water)
+    {
+        tx_stats.high_water = (uint16_t)waiting;
+    }
+
+    tx_start();
+
+    taskEXIT_CRITICAL();
+    return pdPASS;
+}
+
+/* Helper: Put a message in the ring, waiting up to ticks for room */
+static BaseType_t tx_write(const uint8_t *data, uint16_t length, TickType_t ticks)
+{
+    TickType_t start = xTaskGetTickCount();
+    TickType_t waited;
+
+    if (data == NULL || length == 0)
+    {
+        return pdFAIL;
+    }
+
+    while (tx_put(data, length) != pdPASS)
+    {
+        /* Longer than the whole ring, or out of time */
+        waited = xTaskGetTickCount() - start;
+        if (length > UART_TX_RING || waited >= ticks ||
+            xSemaphoreTake(tx_space, ticks - waited) != pdTRUE)
+        {
+            taskENTER_CRITICAL();
+            tx_stats.drops++;
+            tx_stats.bytes_dropped += length;
+            taskEXIT_CRITICAL();
+            return pdFAIL;
+        }
+    }
+
+    return pdPASS;
+}
+
+/* Helper: A transfer ended, free its bytes and start the next run */
+static void tx_complete_from_isr(bool sent, BaseType_t *woken)
+{
+    if (sent)
+    {
+        tx_stats.bytes_sent += tx_inflight;
+    }
+    else
+    {
+        tx_stats.errors++;
+        tx_stats.bytes_dropped += tx_inflight;
+    }
+
+    tx_tail += tx_inflight;
+    tx_inflight = 0;
+    tx_start();
+
+    xSemaphoreGiveFromISR(tx_space, woken);
+}
+
+/* Helper: Frame one received byte */
+static void rx_byte(uint8_t c)
+{
+    uint8_t *line;
+
+    if (rx_discard)
+    {
+        rx_discard = (c != '\n');
+        return;
+    }
+
+    /* Every buffer is waiting for the task, so the whole line goes */
+    if ((uint8_t)(rx_head - rx_tail) == UART_RX_LINES)
+    {
+        rx_stats.overflow++;
+        rx_discard = (c != '\n');
+        return;
+    }
+
+    /* A full buffer without a newline, the terminator has its own byte */
+    if (rx_fill >= UART_RX_BUFFER)
+    {
+        rx_stats.too_long++;
+        rx_fill = 0;
+        rx_discard = (c != '\n');
+        return;
+    }
+
+    line = rx_lines[rx_head & (UART_RX_LINES - 1)];
+    line[rx_fill++] = c;
+
+    if (c == '\n')
+    {
+        line[rx_fill] = '\0';
+        rx_length[rx_head & (UART_RX_LINES - 1)] = rx_fill;
+        rx_fill = 0;
+        rx_stats.lines++;
+
+        /* The line is complete before the task can see it */
+        __DMB();
+        rx_head++;
+    }
+}
+
+/* Helper: Empty the hardware FIFO. From the interrupt, or with it held off */
+static void rx_drain(void)
+{
+    uint8_t c;
+
+    while (cyhal_uart_readable(&uart_obj) > 0)
+    {
+        if (cyhal_uart_getc(&uart_obj, &c, 0) != CY_RSLT_SUCCESS)
+        {
+            break;
+        }
+        rx_stats.bytes++;
+        rx_byte(c);
+    }
+}
+
 void uart_event_handler(void *handler_arg, cyhal_uart_event_t event)
 {
     (void)handler_arg;
-    cy_rslt_t status;
-    uint8_t c;
     portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
     if ((event & CYHAL_UART_IRQ_TX_ERROR) == CYHAL_UART_IRQ_TX_ERROR)
     {
-        /* TX Error occurred */
-        // printf("UART TX Error\r\n");
+        /* Give up on the run rather than stall the ring behind it */
+        cyhal_uart_write_abort(&uart_obj);
+        tx_complete_from_isr(false, &xHigherPriorityTaskWoken);
+    }
+    else if ((event & CYHAL_UART_IRQ_TX_DONE) == CYHAL_UART_IRQ_TX_DONE)
+    {
+        tx_complete_from_isr(true, &xHigherPriorityTaskWoken);
     }
-    else if ((event & CYHAL_UART_IRQ_RX_NOT_EMPTY) == CYHAL_UART_IRQ_RX_NOT_EMPTY)
+
+    if ((event & CYHAL_UART_IRQ_RX_ERROR) == CYHAL_UART_IRQ_RX_ERROR)
+    {
+        /* Framing, parity or FIFO overflow: the line in progress is bad */
+        rx_stats.errors++;
+        rx_fill = 0;
+        rx_discard = true;
+    }
+
+    if ((event & (CYHAL_UART_IRQ_RX_NOT_EMPTY | CYHAL_UART_IRQ_RX_FIFO)) != 0)
     {
-        /* Receive character */
-        status = cyhal_uart_getc(&uart_obj, &c, 0);
-        
-        if (status == CY_RSLT_SUCCESS)
+        rx_stats.interrupts++;
+        rx_drain();
+
+        /* First byte of a burst: from here the FIFO level interrupt and
+           the task's idle check pick up the rest */
+        if ((event & CYHAL_UART_IRQ_RX_NOT_EMPTY) == CYHAL_UART_IRQ_RX_NOT_EMPTY)
         {
-            /* Store received character in buffer */
-            if (uart_rx_index < UART_RX_BUFFER)
-            {
-                uart_rx_buffer[uart_rx_index++] = c;
-                
-                /* Check for end of line characters */
-                if (c == '\n')
-                {
-                    /* Notify receive task that data is ready */
-                    vTaskNotifyGiveFromISR(Task_UART_Rx_Handle, &xHigherPriorityTaskWoken);
-                    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-                }
-            }
-            else
-            {
-                /* Buffer overflow - reset buffer and notify task */
-                // printf("UART RX buffer overflow\r\n");
-                uart_rx_index = 0;
-                vTaskNotifyGiveFromISR(Task_UART_Rx_Handle, &xHigherPriorityTaskWoken);
-                portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-            }
+            cyhal_uart_enable_event(&uart_obj, CYHAL_UART_IRQ_RX_NOT_EMPTY, UART_INT_PRIORITY, false);
+        }
+
+        if (Task_UART_Rx_Handle != NULL)
+        {
+            vTaskNotifyGiveFromISR(Task_UART_Rx_Handle, &xHigherPriorityTaskWoken);
         }
     }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
 cy_rslt_t uart_hw_init(void)
@@ -98,139 +301,77 @@ cy_rslt_t uart_hw_init(void)
         return rslt;
     }
 
+    /* Interrupt once the FIFO holds more than this, not on every byte */
+    rslt = cyhal_uart_set_fifo_level(&uart_obj, CYHAL_UART_FIFO_RX, UART_RX_FIFO_LEVEL);
+
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+
     uart_flush_rx();
 
     /* Register callback */
     cyhal_uart_register_callback(&uart_obj, uart_event_handler, NULL);
 
-    /* Enable receive interrupts */
+    /* Enable receive interrupts, and the end of each transmit run */
     cyhal_uart_enable_event(
         &uart_obj,
-        (cyhal_uart_event_t)(CYHAL_UART_IRQ_RX_NOT_EMPTY),
+        (cyhal_uart_event_t)(CYHAL_UART_IRQ_RX_NOT_EMPTY | CYHAL_UART_IRQ_RX_FIFO | CYHAL_UART_IRQ_RX_ERROR |
+                             CYHAL_UART_IRQ_TX_DONE | CYHAL_UART_IRQ_TX_ERROR),
         UART_INT_PRIORITY,
         true);
     
     return CY_RSLT_SUCCESS;
 }
 
-void task_uart_tx(void *param)
+void task_uart_rx(void *param)
 {
-    uart_message_t msg;
-    BaseType_t rtos_result;
+    bool burst = false;
+    uint8_t index;
 
     (void)param;
 
     for (;;)
     {
-        /* Wait for message in queue */
-        rtos_result = xQueueReceive(q_uart_tx, &msg, portMAX_DELAY);
-
-        if (rtos_result == pdPASS)
+        /* Every RX interrupt notifies; during a burst, no interrupt for
+           UART_RX_IDLE_MS means the line has gone quiet */
+        if (ulTaskNotifyTake(pdTRUE, burst ? pdMS_TO_TICKS(UART_RX_IDLE_MS) : portMAX_DELAY) != 0)
         {
-            /* Transmit data */
-            for (uint16_t i = 0; i < msg.length; i++)
-            {
-                cyhal_uart_putc(&uart_obj, msg.data[i]);
-            }
-
-            // printf("Sent to Pi: %.*s\r\n", msg.length, msg.data);
-
-            /* Free buffer if required */
-            if (msg.requires_free)
-            {
-                vPortFree(msg.data);
-            }
+            burst = true;
         }
-    }
-}
-
-void task_uart_rx(void *param)
-{
-    uint8_t *data_copy;
-
-    (void)param;
-
-    for (;;)
-    {
-        /* Wait for notification from ISR */
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-
-        if (uart_rx_index > 0)
+        else if (burst)
         {
-            /* Allocate memory for received data */
-            data_copy = pvPortMalloc(uart_rx_index + 1);
-
-            if (data_copy != NULL)
-            {
-                /* Copy received data and null-terminate */
-                memcpy(data_copy, uart_rx_buffer, uart_rx_index);
-                data_copy[uart_rx_index] = '\0';
-
-                /* Call registered callback if exists */
-                if (rx_callback != NULL)
-                {
-                    rx_callback(data_copy, uart_rx_index);
-                }
+            /* Collect what is left under the FIFO level, then wait for
+               the first byte of the next burst again */
+            taskENTER_CRITICAL();
+            rx_drain();
+            cyhal_uart_enable_event(&uart_obj, CYHAL_UART_IRQ_RX_NOT_EMPTY, UART_INT_PRIORITY, true);
+            taskEXIT_CRITICAL();
+            burst = false;
+        }
 
-                /* Display received data directly to console - no queue needed */
-                // printf("UART RX (%d bytes): %.*s\r\n", uart_rx_index, uart_rx_index, data_copy);
+        while (rx_tail != rx_head)
+        {
+            /* See the line the head counter says is complete */
+            __DMB();
+            index = rx_tail & (UART_RX_LINES - 1);
 
-                /* Free the allocated memory */
-                vPortFree(data_copy);
-            }
-            else
+            /* In place, the buffer is only reused after the callback */
+            if (rx_callback != NULL)
             {
-                // printf("UART RX memory allocation failed\r\n");
+                rx_callback(rx_lines[index], rx_length[index]);
             }
 
-            /* Reset receive buffer */
-            uart_rx_index = 0;
-            memset(uart_rx_buffer, 0, UART_RX_BUFFER);
+            __DMB();
+            rx_tail++;
         }
     }
 }
 
 BaseType_t uart_send(const uint8_t *data, uint16_t length)
 {
-    uart_message_t msg;
-    uint8_t *buffer;
-
-    if (data == NULL || length == 0)
-    {
-        return pdFAIL;
-    }
-
-    /* Allocate buffer for data */
-    buffer = pvPortMalloc(length);
-
-    if (buffer == NULL)
-    {
-        return pdFAIL;
-    }
-
-    /* Copy data to buffer */
-    memcpy(buffer, data, length);
-
-    /* Prepare message */
-    msg.data = buffer;
-    msg.length = length;
-    msg.requires_free = true;
-
-    /* Send to transmit queue */
-    if (xQueueSendToBack(q_uart_tx, &msg, 0) != pdPASS)
-    {
-        /* Queue full - flush it and try again */
-        uart_flush_tx();
-        
-        if (xQueueSendToBack(q_uart_tx, &msg, 0) != pdPASS)
-        {
-            /* Still failed - give up */
-            vPortFree(buffer);
-            return pdFAIL;
-        }
-    }
-
-    return pdPASS;
+    return tx_write(data, length, 0);
 }
 
 BaseType_t uart_send_string(const char *str)
@@ -245,30 +386,26 @@ BaseType_t uart_send_string(const char *str)
 
 BaseType_t uart_printf(const char *format, ...)
 {
-    char *buffer;
+    char buffer[UART_MSG_LENGTH];
     va_list args;
-    BaseType_t result;
-
-    /* Allocate buffer */
-    buffer = pvPortMalloc(UART_MSG_LENGTH);
-
-    if (buffer == NULL)
-    {
-        return pdFAIL;
-    }
+    int length;
 
     /* Format string */
     va_start(args, format);
-    vsnprintf(buffer, UART_MSG_LENGTH, format, args);
+    length = vsnprintf(buffer, UART_MSG_LENGTH, format, args);
     va_end(args);
 
-    /* Send string */
-    result = uart_send_string(buffer);
-
-    /* Free buffer */
-    vPortFree(buffer);
+    if (length <= 0)
+    {
+        return pdFAIL;
+    }
+    if (length >= UART_MSG_LENGTH)
+    {
+        length = UART_MSG_LENGTH - 1;
+    }
 
-    return result;
+    /* Replies come in bursts, so wait for the ring to drain a little */
+    return tx_write((const uint8_t *)buffer, (uint16_t)length, pdMS_TO_TICKS(UART_TX_WAIT_MS));
 }
 
 void uart_register_rx_callback(uart_rx_callback_t callback)
@@ -281,38 +418,21 @@ cy_rslt_t task_uart_init(void)
 
     cy_rslt_t rslt;
 
-    /* Initialize hardware */
-    rslt = uart_hw_init();
-    
-    if (rslt != CY_RSLT_SUCCESS)
-    {
-        // printf("UART hardware initialization failed\r\n");
-        return rslt;
-    }
-
-    /* Create queues - removed q_uart_rx since we don't need it */
-    q_uart_tx = xQueueCreate(UART_TX_QUEUE, sizeof(uart_message_t));
+    /* Before the interrupt can give it */
+    tx_space = xSemaphoreCreateBinary();
 
-    if (q_uart_tx == NULL)
+    if (tx_space == NULL)
     {
-        // printf("UART queue creation failed\r\n");
-        return 0;
+        // printf("UART semaphore creation failed\r\n");
+        return CY_RSLT_TYPE_ERROR;
     }
 
-    uart_flush_tx();
-
-    /* Create transmit task */
-    rslt = xTaskCreate(
-            task_uart_tx,
-            "UART TX",
-            configMINIMAL_STACK_SIZE * 2,
-            NULL,
-            configMAX_PRIORITIES - 5,
-            NULL);
+    /* Initialize hardware */
+    rslt = uart_hw_init();
     
-    if (rslt != pdPASS)
+    if (rslt != CY_RSLT_SUCCESS)
     {
-        // printf("UART TX task creation failed\r\n");
+        // printf("UART hardware initialization failed\r\n");
         return rslt;
     }
 
@@ -338,30 +458,40 @@ void uart_flush_rx(void)
 {
     uint8_t dummy;
     
-    // Clear any pending data in UART hardware FIFO
+    /* Clear the hardware FIFO and any partial line; complete lines still
+       go to the callback */
+    taskENTER_CRITICAL();
     while (cyhal_uart_readable(&uart_obj) > 0)
     {
         cyhal_uart_getc(&uart_obj, &dummy, 0);
     }
-    
-    // Clear software buffer
-    uart_rx_index = 0;
-    memset(uart_rx_buffer, 0, UART_RX_BUFFER);
-    
-    // printf("UART RX buffer flushed\r\n");
+    rx_fill = 0;
+    rx_discard = false;
+    taskEXIT_CRITICAL();
 }
 
-
 void uart_flush_tx(void)
 {
-    uart_message_t msg;
-    
-    /* Drain the queue and free any allocated buffers */
-    while (xQueueReceive(q_uart_tx, &msg, 0) == pdPASS)
-    {
-        if (msg.requires_free && msg.data != NULL)
-        {
-            vPortFree(msg.data);
-        }
-    }
-}
\ No newline at end of file
+    uint32_t discarded;
+
+    /* Drop everything not already handed to the HAL */
+    taskENTER_CRITICAL();
+    discarded = tx_head - tx_tail - tx_inflight;
+    tx_head = tx_tail + tx_inflight;
+    tx_stats.bytes_dropped += discarded;
+    taskEXIT_CRITICAL();
+}
+
+void uart_get_tx_stats(uart_tx_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = tx_stats;
+    taskEXIT_CRITICAL();
+}
+
+void uart_get_rx_stats(uart_rx_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = rx_stats;
+    taskEXIT_CRITICAL();
+}
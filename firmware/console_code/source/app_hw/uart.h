@@ -13,30 +13,60 @@
 
 #define UART_INT_PRIORITY           4
 
-#define UART_RX_BUFFER              256
-#define UART_TX_BUFFER              256
-
-#define UART_RX_QUEUE               10
-#define UART_TX_QUEUE               32
-
-#define UART_MSG_LENGTH             128
-
-
-typedef struct 
+#define UART_RX_BUFFER              256     /* Longest line from the Pi, with the newline */
+#define UART_RX_LINES               4       /* Power of two */
+#define UART_RX_FIFO_LEVEL          16      /* Bytes in the FIFO before an interrupt */
+#define UART_RX_IDLE_MS             3       /* Quiet time that ends a burst */
+#define UART_TX_RING                1024    /* Power of two */
+
+#define UART_MSG_LENGTH             128     /* Longest uart_printf line */
+#define UART_TX_WAIT_MS             50      /* How long uart_printf waits for room */
+
+/*
+ * Transmit to the Pi through one static byte ring, no heap and no task.
+ * Senders copy the message in and the HAL sends it from the ring with
+ * interrupts, a FIFO's worth at a time, starting the next run when the
+ * last one is done.
+ *
+ * A message goes in whole or not at all. uart_send() and uart_send_string()
+ * never wait: if the ring is full the message is dropped and counted, so
+ * game events never hold up the input task. uart_printf() waits up to
+ * UART_TX_WAIT_MS for room, for query replies that come many lines at once.
+ * All three are for tasks, not interrupts.
+ */
+typedef struct
 {
-    uint8_t *data;
-    uint16_t length;
-    bool requires_free;
-} uart_message_t;
-
+    uint32_t bytes_sent;
+    uint32_t bytes_dropped;     /* Bytes of those that did not fit, flushed or failed */
+    uint32_t drops;             /* Messages that did not fit */
+    uint32_t errors;            /* Transfers the HAL gave up on */
+    uint16_t high_water;        /* Most bytes waiting at once */
+} uart_tx_stats_t;
+
+/*
+ * Receive from the Pi a line at a time, no heap. The first byte of a burst
+ * interrupts; after that the FIFO level interrupt empties the FIFO
+ * UART_RX_FIFO_LEVEL bytes at a time, and once the link has been quiet for
+ * UART_RX_IDLE_MS the RX task collects the rest and waits for the next
+ * first byte. Bytes are framed into UART_RX_LINES buffers as they are
+ * read, so lines arriving back to back stay apart while the callback runs.
+ */
+typedef struct
+{
+    uint32_t bytes;
+    uint32_t lines;
+    uint32_t interrupts;        /* Far fewer than bytes on a busy link */
+    uint32_t overflow;          /* Lines dropped, every buffer was waiting */
+    uint32_t too_long;          /* Lines dropped, no newline within UART_RX_BUFFER */
+    uint32_t errors;            /* Framing, parity or FIFO overflow, the line is dropped */
+} uart_rx_stats_t;
+
+/* A complete line with its newline, NUL terminated. The buffer is reused
+   once the callback returns */
 typedef void (*uart_rx_callback_t)(uint8_t *data, uint16_t length);
 
 extern cyhal_uart_t uart_obj;
 
-/* Queue Handles */
-extern QueueHandle_t q_uart_rx;
-extern QueueHandle_t q_uart_tx;
-
 /* Task Handle */
 extern TaskHandle_t Task_UART_Rx_Handle;
 
@@ -44,8 +74,6 @@ cy_rslt_t uart_hw_init(void);
 
 cy_rslt_t task_uart_init(void);
 
-void task_uart_tx(void *param);
-
 void task_uart_rx(void *param);
 
 BaseType_t uart_send(const uint8_t *data, uint16_t length);
@@ -61,5 +89,9 @@ void uart_event_handler(void *handler_arg, cyhal_uart_event_t event);
 void uart_flush_rx(void);
 void uart_flush_tx(void);
 
+void uart_get_tx_stats(uart_tx_stats_t *stats);
+
+void uart_get_rx_stats(uart_rx_stats_t *stats);
+
 
 #endif
\ No newline at end of file
@@ -16,6 +16,8 @@
 #include "task_bluetooth.h"
 #include "ece453_pins.h"
 #include "task_button.h"
+#include "timestamp.h"
+#include "boot_timeline.h"
 
 /* External variables from spi.c */
 extern cyhal_spi_t mSPI;
@@ -45,6 +47,11 @@ int main(void)
     /* Initialize EEPROM Chip Select (CS) pin as GPIO output */
     rslt = cyhal_gpio_init(MOD_1_PIN_SPI_CS_N, CYHAL_GPIO_DIR_OUTPUT, CYHAL_GPIO_DRIVE_STRONG, true);
     CY_ASSERT(rslt == CY_RSLT_SUCCESS); 
+
+    /* Start the 1 MHz timestamp counter used to stamp IMU samples */
+    rslt = timestamp_init();
+    CY_ASSERT(rslt == CY_RSLT_SUCCESS);
+    boot_timeline_init();
     
     /* Initialize console task */
     task_console_init();
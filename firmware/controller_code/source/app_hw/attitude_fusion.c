@@ -0,0 +1,211 @@
+#include "attitude_fusion.h"
+#include "cy_pdl.h"
+#include <string.h>
+
+#define PI_F                    3.14159265f
+
+/* Gyro/accel full scale and rate, kept for attitude_set_rate() */
+static float gyro_rad_per_lsb;
+
+static attitude_stats_t stats;
+static bool cycle_counter_ready = false;
+
+/* Q30 x Q30 -> Q30 */
+static inline int32_t q30_mul(int32_t a, int32_t b)
+{
+    return (int32_t)(((int64_t)a * b) >> 30);
+}
+
+static uint32_t isqrt32(uint32_t n)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > n) bit >>= 2;
+    while (bit != 0) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/*
+ * atan of z in [0, 1] (Q15), result in 1/16 degree.
+ * atan(z) ~= pi/4 z - z (z - 1)(0.2447 + 0.0663 z), max error 0.09 degree.
+ */
+static int32_t atan_unit_deg16(int32_t z)
+{
+    int32_t c = 8018 + ((2173 * z) >> 15);
+    int32_t t = (z * (z - 32768)) >> 15;
+    int32_t rad_q15 = ((25736 * z) >> 15) - ((t * c) >> 15);
+
+    /* 16 * 180 / pi = 916.73 = 29335 / 32 */
+    return (rad_q15 * 29335) >> 20;
+}
+
+/* Four-quadrant atan2 in 1/16 degree; y and x only need matching scale */
+static int16_t atan2_deg16(int32_t y, int32_t x)
+{
+    int32_t ay = (y < 0) ? -y : y;
+    int32_t ax = (x < 0) ? -x : x;
+    int32_t angle;
+
+    if (ax == 0 && ay == 0) return 0;
+
+    /* Drop to 15 bits so the ratio fits the polynomial */
+    while (ax > 0x7FFF || ay > 0x7FFF) {
+        ax >>= 1;
+        ay >>= 1;
+    }
+
+    if (ay <= ax) {
+        angle = atan_unit_deg16((ay << 15) / ax);
+    } else {
+        angle = 90 * 16 - atan_unit_deg16((ax << 15) / ay);
+    }
+
+    if (x < 0) angle = 180 * 16 - angle;
+    return (int16_t)((y < 0) ? -angle : angle);
+}
+
+/* Body-frame gravity direction from the quaternion, Q30 */
+static void attitude_gravity(const attitude_t *att, int32_t *vx, int32_t *vy, int32_t *vz)
+{
+    const int32_t *q = att->q;
+
+    *vx = 2 * (q30_mul(q[1], q[3]) - q30_mul(q[0], q[2]));
+    *vy = 2 * (q30_mul(q[0], q[1]) + q30_mul(q[2], q[3]));
+    *vz = q30_mul(q[0], q[0]) - q30_mul(q[1], q[1]) - q30_mul(q[2], q[2]) + q30_mul(q[3], q[3]);
+}
+
+void attitude_set_rate(attitude_t *att, uint16_t odr_hz)
+{
+    float half_dt = 0.5f / (float)odr_hz;
+
+    att->gyro_half_step_q46 = (int32_t)(gyro_rad_per_lsb * half_dt * 70368744177664.0f);
+    att->half_dt_q30 = (int32_t)(half_dt * Q30_ONE);
+    att->kp_half_dt_q30 = (int32_t)(ATTITUDE_KP * half_dt * Q30_ONE);
+    att->kp_settle_half_dt_q30 = (int32_t)(ATTITUDE_KP_SETTLE * half_dt * Q30_ONE);
+    att->ki_dt_q30 = (int32_t)(ATTITUDE_KI * 2.0f * half_dt * Q30_ONE);
+    att->settle_samples = ((uint32_t)odr_hz * ATTITUDE_SETTLE_MS) / 1000;
+}
+
+void attitude_init(attitude_t *att, uint16_t odr_hz, uint32_t gyro_udps_per_lsb, uint8_t accel_fs_g)
+{
+    memset(att, 0, sizeof(*att));
+    att->q[0] = Q30_ONE;
+    att->accel_one_g = 32768 / accel_fs_g;
+
+    gyro_rad_per_lsb = (float)gyro_udps_per_lsb * 1e-6f * (PI_F / 180.0f);
+    attitude_set_rate(att, odr_hz);
+
+    memset(&stats, 0, sizeof(stats));
+    if (!cycle_counter_ready) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        cycle_counter_ready = true;
+    }
+}
+
+void attitude_update(attitude_t *att, int16_t gx, int16_t gy, int16_t gz,
+                     int16_t ax, int16_t ay, int16_t az)
+{
+    uint32_t start = DWT->CYCCNT;
+    int32_t *q = att->q;
+    int32_t hx, hy, hz;
+
+    /* Gyro as half-angle step for this sample, Q30 rad */
+    hx = (int32_t)(((int64_t)gx * att->gyro_half_step_q46) >> 16);
+    hy = (int32_t)(((int64_t)gy * att->gyro_half_step_q46) >> 16);
+    hz = (int32_t)(((int64_t)gz * att->gyro_half_step_q46) >> 16);
+
+    /* Accel feedback, skipped when the magnitude says it is not just gravity */
+    uint32_t n2 = (uint32_t)((int32_t)ax * ax) + (uint32_t)((int32_t)ay * ay) + (uint32_t)((int32_t)az * az);
+    uint32_t n = isqrt32(n2);
+    uint32_t n_min = (uint32_t)att->accel_one_g * ATTITUDE_ACCEL_MIN_PCT / 100;
+    uint32_t n_max = (uint32_t)att->accel_one_g * ATTITUDE_ACCEL_MAX_PCT / 100;
+
+    if (n >= n_min && n <= n_max) {
+        /* Unit accel in Q30: a * (2^31 / n) / 2 */
+        int32_t inv = (int32_t)(0x80000000UL / n);
+        int32_t ux = (int32_t)(((int64_t)ax * inv) >> 1);
+        int32_t uy = (int32_t)(((int64_t)ay * inv) >> 1);
+        int32_t uz = (int32_t)(((int64_t)az * inv) >> 1);
+        int32_t vx, vy, vz;
+
+        attitude_gravity(att, &vx, &vy, &vz);
+
+        /* Error is the cross product of measured and estimated gravity */
+        int32_t ex = q30_mul(uy, vz) - q30_mul(uz, vy);
+        int32_t ey = q30_mul(uz, vx) - q30_mul(ux, vz);
+        int32_t ez = q30_mul(ux, vy) - q30_mul(uy, vx);
+
+        int32_t kp = (att->updates < att->settle_samples) ? att->kp_settle_half_dt_q30 : att->kp_half_dt_q30;
+
+        att->bias[0] += q30_mul(ex, att->ki_dt_q30);
+        att->bias[1] += q30_mul(ey, att->ki_dt_q30);
+        att->bias[2] += q30_mul(ez, att->ki_dt_q30);
+
+        hx += q30_mul(ex, kp) + q30_mul(att->bias[0], att->half_dt_q30);
+        hy += q30_mul(ey, kp) + q30_mul(att->bias[1], att->half_dt_q30);
+        hz += q30_mul(ez, kp) + q30_mul(att->bias[2], att->half_dt_q30);
+    } else {
+        stats.accel_rejected++;
+        hx += q30_mul(att->bias[0], att->half_dt_q30);
+        hy += q30_mul(att->bias[1], att->half_dt_q30);
+        hz += q30_mul(att->bias[2], att->half_dt_q30);
+    }
+
+    /* q += 0.5 * q * (0, w) * dt */
+    int32_t q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    q[0] += -q30_mul(q1, hx) - q30_mul(q2, hy) - q30_mul(q3, hz);
+    q[1] +=  q30_mul(q0, hx) + q30_mul(q2, hz) - q30_mul(q3, hy);
+    q[2] +=  q30_mul(q0, hy) - q30_mul(q1, hz) + q30_mul(q3, hx);
+    q[3] +=  q30_mul(q0, hz) + q30_mul(q1, hy) - q30_mul(q2, hx);
+
+    /* Renormalise with one Newton step, |q| stays within a hair of 1 */
+    int64_t n2q = (int64_t)q[0] * q[0] + (int64_t)q[1] * q[1] + (int64_t)q[2] * q[2] + (int64_t)q[3] * q[3];
+    int32_t scale = (int32_t)(((3LL << 30) - (n2q >> 30)) >> 1);
+    q[0] = q30_mul(q[0], scale);
+    q[1] = q30_mul(q[1], scale);
+    q[2] = q30_mul(q[2], scale);
+    q[3] = q30_mul(q[3], scale);
+
+    att->updates++;
+
+    uint32_t cycles = DWT->CYCCNT - start;
+    stats.updates++;
+    stats.cycles_last = cycles;
+    if (cycles > stats.cycles_max) stats.cycles_max = cycles;
+    stats.cycles_avg = (stats.cycles_avg == 0) ? cycles : stats.cycles_avg + (((int32_t)cycles - (int32_t)stats.cycles_avg) >> 4);
+    if (cycles > ATTITUDE_CYCLE_BUDGET) stats.over_budget++;
+}
+
+void attitude_get_tilt(const attitude_t *att, int16_t *roll, int16_t *pitch)
+{
+    int32_t vx, vy, vz;
+    attitude_gravity(att, &vx, &vy, &vz);
+
+    /* Q30 -> Q15 keeps the squares inside 32 bits */
+    int32_t y15 = vy >> 15, z15 = vz >> 15;
+    int32_t yz = (int32_t)isqrt32((uint32_t)(y15 * y15 + z15 * z15));
+
+    *roll = atan2_deg16(vx >> 15, yz);
+    *pitch = atan2_deg16(vy, vz);
+}
+
+void attitude_get_quat(const attitude_t *att, int32_t q[4])
+{
+    memcpy(q, att->q, sizeof(att->q));
+}
+
+void attitude_get_stats(attitude_stats_t *out)
+{
+    *out = stats;
+}
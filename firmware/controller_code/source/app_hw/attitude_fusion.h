@@ -0,0 +1,94 @@
+#ifndef ATTITUDE_FUSION_H
+#define ATTITUDE_FUSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Fixed-point Mahony attitude filter for raw LSM6DSM gyro/accel data.
+ *
+ * Quaternion and gravity estimate are Q30, the gyro is integrated every
+ * FIFO sample (416/833 Hz) and the accelerometer pulls roll/pitch back with
+ * a PI feedback loop. No floating point on the update path.
+ *
+ * Cycle budget: one attitude_update() must stay under ATTITUDE_CYCLE_BUDGET
+ * CM4 cycles (measured with the DWT cycle counter). That is 1000 cycles,
+ * or 10 us at 100 MHz and 0.8% of the CPU at 833 Hz.
+ */
+
+#define ATTITUDE_CYCLE_BUDGET   1000
+
+/* Feedback gains: Kp pulls toward gravity, Ki trims gyro bias */
+#define ATTITUDE_KP             1.0f
+#define ATTITUDE_KI             0.02f
+
+/* Higher Kp while settling after init so roll/pitch lock on within ~0.5 s */
+#define ATTITUDE_KP_SETTLE      10.0f
+#define ATTITUDE_SETTLE_MS      500
+
+/* Accel magnitude window (percent of 1 g) outside which it is ignored, e.g. mid-flick */
+#define ATTITUDE_ACCEL_MIN_PCT  75
+#define ATTITUDE_ACCEL_MAX_PCT  125
+
+#define Q30_ONE                 (1L << 30)
+
+typedef struct {
+    int32_t q[4];               /* w, x, y, z in Q30 */
+    int32_t bias[3];            /* Integral feedback, rad/s in Q30 */
+
+    /* Per-rate constants, see attitude_set_rate() */
+    int32_t gyro_half_step_q46; /* rad per raw LSB per half sample period */
+    int32_t kp_half_dt_q30;
+    int32_t kp_settle_half_dt_q30;
+    int32_t ki_dt_q30;
+    int32_t half_dt_q30;
+    int32_t accel_one_g;        /* Raw LSB for 1 g */
+    uint32_t settle_samples;
+
+    uint32_t updates;
+} attitude_t;
+
+typedef struct {
+    uint32_t updates;
+    uint32_t cycles_last;
+    uint32_t cycles_max;
+    uint32_t cycles_avg;        /* Running average, 1/16 weight */
+    uint32_t over_budget;       /* Updates above ATTITUDE_CYCLE_BUDGET */
+    uint32_t accel_rejected;    /* Updates where accel was outside the 1 g window */
+} attitude_stats_t;
+
+/**
+ * @brief Reset to level and set the sensor scales.
+ * @param odr_hz Rate attitude_update() is called at
+ * @param gyro_udps_per_lsb Gyro sensitivity, µdps per LSB (35000 at ±1000 dps)
+ * @param accel_fs_g Accel full scale (e.g. 4)
+ */
+void attitude_init(attitude_t *att, uint16_t odr_hz, uint32_t gyro_udps_per_lsb, uint8_t accel_fs_g);
+
+/**
+ * @brief Recompute the per-rate constants after an ODR change, keeps the attitude.
+ */
+void attitude_set_rate(attitude_t *att, uint16_t odr_hz);
+
+/**
+ * @brief Integrate one raw gyro/accel set.
+ */
+void attitude_update(attitude_t *att, int16_t gx, int16_t gy, int16_t gz,
+                     int16_t ax, int16_t ay, int16_t az);
+
+/**
+ * @brief Roll and pitch in 1/16 degree, same convention as the accel-only tilt.
+ */
+void attitude_get_tilt(const attitude_t *att, int16_t *roll, int16_t *pitch);
+
+/**
+ * @brief Attitude quaternion w, x, y, z, unit length in Q30.
+ */
+void attitude_get_quat(const attitude_t *att, int32_t q[4]);
+
+/**
+ * @brief Copy the update timing counters.
+ */
+void attitude_get_stats(attitude_stats_t *stats);
+
+#endif /* ATTITUDE_FUSION_H */
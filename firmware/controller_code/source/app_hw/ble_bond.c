@@ -0,0 +1,115 @@
+#include "ble_bond.h"
+#include "task_eeprom.h"
+#include "task_console.h"
+#include <stddef.h>
+#include <string.h>
+
+#define BOND_MAGIC_NUM          0xB0
+#define BOND_VERSION            1       /* Bump when the layout or the stack's key structures change */
+
+#define BOND_HAS_PEER           0x01
+#define BOND_HAS_IDENTITY       0x02
+
+typedef struct __attribute__((packed)) {
+    uint8_t magic_num;          /* BOND_MAGIC_NUM */
+    uint8_t version;            /* BOND_VERSION */
+    uint8_t flags;              /* BOND_HAS_x */
+    wiced_bt_device_link_keys_t peer;
+    wiced_bt_local_identity_keys_t identity;
+    uint16_t crc;               /* CRC-16/CCITT of everything above */
+} bond_record_t;
+
+static bond_record_t bond;
+
+/* Helper: Queue the whole record for writing */
+static void store_bond(void)
+{
+    bond.magic_num = BOND_MAGIC_NUM;
+    bond.version = BOND_VERSION;
+    bond.crc = task_eeprom_crc16((const uint8_t *)&bond, offsetof(bond_record_t, crc));
+
+    /* Stack thread, so no waiting for room */
+    if (!task_eeprom_write(BOND_EEPROM_ADDR, (const uint8_t *)&bond, sizeof(bond), 0)) {
+        task_print_error("BLE: EEPROM busy, bond not stored");
+    }
+}
+
+bool ble_bond_load(void)
+{
+    bool ok = task_eeprom_read(BOND_EEPROM_ADDR, (uint8_t *)&bond, sizeof(bond)) &&
+              bond.magic_num == BOND_MAGIC_NUM &&
+              bond.version == BOND_VERSION &&
+              bond.crc == task_eeprom_crc16((const uint8_t *)&bond, offsetof(bond_record_t, crc));
+
+    /* Blank, stale or unreadable: pair again with whichever console connects */
+    if (!ok) memset(&bond, 0, sizeof(bond));
+    return (bond.flags & BOND_HAS_PEER) != 0;
+}
+
+/* Helper: True if pairing handed over an identity address (the console uses
+   a private address), else bond.peer.bd_addr is the only address we have */
+static bool peer_has_static_addr(void)
+{
+    static const wiced_bt_device_address_t zero_addr = { 0 };
+
+    return memcmp(bond.peer.key_data.static_addr, zero_addr, BD_ADDR_LEN) != 0;
+}
+
+bool ble_bond_peer(wiced_bt_device_address_t bd_addr, wiced_bt_ble_address_type_t *addr_type)
+{
+    if ((bond.flags & BOND_HAS_PEER) == 0) return false;
+
+    if (peer_has_static_addr()) {
+        memcpy(bd_addr, bond.peer.key_data.static_addr, BD_ADDR_LEN);
+        *addr_type = bond.peer.key_data.static_addr_type;
+    } else {
+        memcpy(bd_addr, bond.peer.bd_addr, BD_ADDR_LEN);
+        *addr_type = bond.peer.key_data.ble_addr_type;
+    }
+    return true;
+}
+
+bool ble_bond_is_peer(const wiced_bt_device_address_t bd_addr)
+{
+    if ((bond.flags & BOND_HAS_PEER) == 0) return false;
+
+    return memcmp(bd_addr, bond.peer.bd_addr, BD_ADDR_LEN) == 0 ||
+           (peer_has_static_addr() && memcmp(bd_addr, bond.peer.key_data.static_addr, BD_ADDR_LEN) == 0);
+}
+
+void ble_bond_stack_ready(void)
+{
+    wiced_bt_device_link_keys_t keys;
+
+    if ((bond.flags & BOND_HAS_PEER) == 0) return;
+    memcpy(&keys, &bond.peer, sizeof(keys));
+    wiced_bt_dev_add_device_to_address_resolution_db(&keys);
+}
+
+void ble_bond_keys_update(const wiced_bt_device_link_keys_t *keys)
+{
+    memcpy(&bond.peer, keys, sizeof(bond.peer));
+    bond.flags |= BOND_HAS_PEER;
+    store_bond();
+}
+
+bool ble_bond_keys_request(wiced_bt_device_link_keys_t *keys)
+{
+    if (!ble_bond_is_peer(keys->bd_addr)) return false;
+    memcpy(keys, &bond.peer, sizeof(*keys));
+    return true;
+}
+
+void ble_bond_identity_update(const wiced_bt_local_identity_keys_t *keys)
+{
+    memcpy(&bond.identity, keys, sizeof(bond.identity));
+    bond.flags |= BOND_HAS_IDENTITY;
+    store_bond();
+}
+
+bool ble_bond_identity_request(wiced_bt_local_identity_keys_t *keys)
+{
+    if ((bond.flags & BOND_HAS_IDENTITY) == 0) return false;
+    memcpy(keys, &bond.identity, sizeof(*keys));
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef BLE_BOND_H
+#define BLE_BOND_H
+
+#include "main.h"
+#include "wiced_bt_dev.h"
+#include "wiced_bt_ble.h"
+
+/*
+ * Bond with the console, kept in the SPI EEPROM through the EEPROM task.
+ * One console at a time: pairing with another replaces the record. Besides
+ * the keys the stack asks for, the record gives the console's identity
+ * address, which directed advertising after a link loss is sent to.
+ *
+ * The record lives in RAM once loaded; the stack callbacks read and update
+ * it there and the EEPROM write is queued, so they never block.
+ */
+
+#define BOND_EEPROM_ADDR        0x0100  /* Clear of the IMU calibration at 0x0000 */
+
+/**
+ * @brief Read the record through the EEPROM task. Blocks, so call from a
+ * task before the stack starts.
+ * @return true if a console is bonded
+ */
+bool ble_bond_load(void);
+
+/**
+ * @brief Identity address and address type of the bonded console, or the
+ * address it paired from if it did not distribute one.
+ * @return false if none
+ */
+bool ble_bond_peer(wiced_bt_device_address_t bd_addr, wiced_bt_ble_address_type_t *addr_type);
+
+/**
+ * @brief True if bd_addr is the bonded console, by either the address it
+ * paired from or its identity address.
+ */
+bool ble_bond_is_peer(const wiced_bt_device_address_t bd_addr);
+
+/**
+ * @brief Let the stack resolve the bonded console. Call on BTM_ENABLED_EVT.
+ */
+void ble_bond_stack_ready(void);
+
+/* Management events with keys. Updates replace the record and queue the
+   EEPROM write; requests return false if there is nothing stored */
+void ble_bond_keys_update(const wiced_bt_device_link_keys_t *keys);
+bool ble_bond_keys_request(wiced_bt_device_link_keys_t *keys);
+void ble_bond_identity_update(const wiced_bt_local_identity_keys_t *keys);
+bool ble_bond_identity_request(wiced_bt_local_identity_keys_t *keys);
+
+#endif /* BLE_BOND_H */
@@ -2,6 +2,7 @@
 #include "FreeRTOS.h"
 #include "semphr.h"
 #include "task_console.h"
+#include <string.h>
 
 static cyhal_uart_t *bno_uart;
 static SemaphoreHandle_t bno_uart_mutex = NULL;
@@ -11,82 +12,222 @@ static SemaphoreHandle_t bno_uart_mutex = NULL;
 #define BNO055_DEBUG 0
 #endif
 
-/* Helper: Write a register via BNO055 UART Protocol */
-static cy_rslt_t bno055_write_reg(uint8_t reg, uint8_t data)
+#define BNO055_RX_RING_MASK (BNO055_RX_RING_SIZE - 1)
+
+/* RX ring buffer: head is advanced by the UART ISR, tail by the waiting task */
+static volatile uint8_t rx_ring[BNO055_RX_RING_SIZE];
+static volatile uint16_t rx_head = 0;
+static volatile uint16_t rx_tail = 0;
+static volatile uint32_t rx_overruns = 0;
+
+/* Task blocked on the current transfer and the byte count it needs to progress */
+static volatile TaskHandle_t rx_waiter = NULL;
+static volatile uint16_t rx_wake_level = 0;
+
+/* Response frame parser */
+typedef enum {
+    BNO_RX_SYNC,        /* Waiting for 0xBB (read data) or 0xEE (status) */
+    BNO_RX_LENGTH,      /* Got 0xBB, next byte is the payload length */
+    BNO_RX_DATA,        /* Collecting payload bytes */
+    BNO_RX_STATUS       /* Got 0xEE, next byte is the status code */
+} bno055_rx_state_t;
+
+typedef enum {
+    BNO_XFER_PENDING,
+    BNO_XFER_DONE,
+    BNO_XFER_FAILED
+} bno055_xfer_result_t;
+
+typedef struct {
+    bno055_rx_state_t state;
+    bool is_read;
+    uint8_t expected_len;
+    uint8_t count;
+    uint8_t status;
+    uint8_t data[128];
+    TickType_t deadline;
+} bno055_xfer_t;
+
+static bno055_xfer_t xfer;
+
+static inline uint16_t rx_ring_count(void)
 {
-    if (bno_uart == NULL) return CY_RSLT_TYPE_ERROR;
+    return (uint16_t)((rx_head - rx_tail) & BNO055_RX_RING_MASK);
+}
 
-    if (bno_uart_mutex) xSemaphoreTake(bno_uart_mutex, portMAX_DELAY);
+/* UART ISR: drain the hardware FIFO into the ring and wake the waiter once enough bytes are in */
+static void bno055_uart_event_handler(void *handler_arg, cyhal_uart_event_t event)
+{
+    (void)handler_arg;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    cyhal_uart_clear(bno_uart);
+    if ((event & CYHAL_UART_IRQ_RX_NOT_EMPTY) == CYHAL_UART_IRQ_RX_NOT_EMPTY)
+    {
+        uint8_t c;
+        while (cyhal_uart_readable(bno_uart) > 0 && cyhal_uart_getc(bno_uart, &c, 0) == CY_RSLT_SUCCESS)
+        {
+            uint16_t next = (rx_head + 1) & BNO055_RX_RING_MASK;
+            if (next != rx_tail) {
+                rx_ring[rx_head] = c;
+                rx_head = next;
+            } else {
+                rx_overruns++;
+            }
+        }
 
-    uint8_t packet[5];
-    packet[0] = BNO_UART_START_BYTE;
-    packet[1] = BNO_UART_WRITE;
-    packet[2] = reg;
-    packet[3] = 1;
-    packet[4] = data;
+        if (rx_waiter != NULL && rx_ring_count() >= rx_wake_level)
+        {
+            TaskHandle_t waiter = rx_waiter;
+            rx_waiter = NULL;
+            vTaskNotifyGiveFromISR(waiter, &xHigherPriorityTaskWoken);
+        }
+    }
 
-    if (BNO055_DEBUG) task_print_info("BNO055: TX -> [ %02X %02X %02X %02X %02X ]", packet[0], packet[1], packet[2], packet[3], packet[4]);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
 
-    for (int i = 0; i < 5; ++i) {
-        if (cyhal_uart_putc(bno_uart, packet[i]) != CY_RSLT_SUCCESS) {
-            if (bno_uart_mutex) xSemaphoreGive(bno_uart_mutex);
-            task_print_error("BNO055: UART TX failed sending byte %d", i);
-            return CY_RSLT_TYPE_ERROR;
+/* Helper: Consume buffered bytes through the frame state machine */
+static bno055_xfer_result_t bno055_rx_parse(void)
+{
+    while (rx_ring_count() > 0)
+    {
+        uint8_t b = rx_ring[rx_tail];
+        rx_tail = (rx_tail + 1) & BNO055_RX_RING_MASK;
+
+        switch (xfer.state)
+        {
+            case BNO_RX_SYNC:
+                if (b == BNO_UART_READ_RESP && xfer.is_read) xfer.state = BNO_RX_LENGTH;
+                else if (b == BNO_UART_ACK_RESP) xfer.state = BNO_RX_STATUS;
+                else if (BNO055_DEBUG) task_print_info("BNO055: Skipped byte while waiting for header: 0x%02X", b);
+                break;
+
+            case BNO_RX_LENGTH:
+                if (b != xfer.expected_len) {
+                    if (BNO055_DEBUG) task_print_warning("BNO055: Length mismatch (%u != %u)", b, xfer.expected_len);
+                    return BNO_XFER_FAILED;
+                }
+                xfer.count = 0;
+                xfer.state = BNO_RX_DATA;
+                break;
+
+            case BNO_RX_DATA:
+                xfer.data[xfer.count++] = b;
+                if (xfer.count >= xfer.expected_len) return BNO_XFER_DONE;
+                break;
+
+            case BNO_RX_STATUS:
+                xfer.status = b;
+                /* A status frame only completes a write; for a read it reports a bus error */
+                if (!xfer.is_read && b == BNO_UART_WRITE_SUCCESS) return BNO_XFER_DONE;
+                return BNO_XFER_FAILED;
         }
     }
+    return BNO_XFER_PENDING;
+}
 
-    uint8_t recv_buf[8];
-    int recv_count = 0;
-    const TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(200);
-    while (xTaskGetTickCount() < deadline && recv_count < (int)sizeof(recv_buf)) {
-        uint8_t b;
-        cy_rslt_t r = cyhal_uart_getc(bno_uart, &b, 20);
-        if (r == CY_RSLT_SUCCESS) {
-            recv_buf[recv_count++] = b;
-        }
+/* Helper: Bytes still required before the parser can make progress */
+static uint16_t bno055_rx_bytes_needed(void)
+{
+    switch (xfer.state)
+    {
+        case BNO_RX_SYNC:   return 2;
+        case BNO_RX_LENGTH: return 1 + xfer.expected_len;
+        case BNO_RX_DATA:   return xfer.expected_len - xfer.count;
+        default:            return 1;
     }
+}
 
-    if (bno_uart_mutex) xSemaphoreGive(bno_uart_mutex);
+/* Helper: Block until the current transfer completes or its deadline passes */
+static bno055_xfer_result_t bno055_xfer_wait(void)
+{
+    bno055_xfer_result_t res;
 
-    if (recv_count == 0) {
-        task_print_error("BNO055: Write Timeout (Reg: 0x%02X) - no response", reg);
+    while ((res = bno055_rx_parse()) == BNO_XFER_PENDING)
+    {
+        TickType_t now = xTaskGetTickCount();
+        if ((int32_t)(xfer.deadline - now) <= 0) return BNO_XFER_FAILED;
+
+        /* Arm the ISR, then re-check so a byte landing in between is not missed */
+        rx_wake_level = bno055_rx_bytes_needed();
+        rx_waiter = xTaskGetCurrentTaskHandle();
+        if (rx_ring_count() < rx_wake_level) {
+            ulTaskNotifyTake(pdTRUE, xfer.deadline - now);
+        }
+        rx_waiter = NULL;
+    }
+    return res;
+}
+
+/* Helper: Reset the parser and send a command frame */
+static cy_rslt_t bno055_xfer_begin(const uint8_t *cmd, size_t cmd_len, bool is_read, uint8_t len)
+{
+    /* Drop stale bytes and any notification left over from a timed out transfer */
+    rx_tail = rx_head;
+    (void)ulTaskNotifyTake(pdTRUE, 0);
+
+    xfer.state = BNO_RX_SYNC;
+    xfer.is_read = is_read;
+    xfer.expected_len = len;
+    xfer.count = 0;
+    xfer.status = 0;
+    xfer.deadline = xTaskGetTickCount() +
+                    pdMS_TO_TICKS(BNO055_XFER_TIMEOUT_MS(cmd_len + 2u + (is_read ? len : 0u)));
+
+    /* Command frames are at most 4 + BNO055_WRITE_MAX bytes, so they always fit in the TX FIFO */
+    size_t tx_len = cmd_len;
+    if (cyhal_uart_write(bno_uart, (void *)cmd, &tx_len) != CY_RSLT_SUCCESS || tx_len != cmd_len) {
         return CY_RSLT_TYPE_ERROR;
     }
+    return CY_RSLT_SUCCESS;
+}
+
+/* Helper: Write consecutive registers via BNO055 UART Protocol */
+static cy_rslt_t bno055_write_regs(uint8_t reg, const uint8_t *data, uint8_t len)
+{
+    if (bno_uart == NULL || data == NULL || len == 0 || len > BNO055_WRITE_MAX) return CY_RSLT_TYPE_ERROR;
+
+    if (bno_uart_mutex) xSemaphoreTake(bno_uart_mutex, portMAX_DELAY);
 
-    /* Log received stream (verbose only) */
-    if (BNO055_DEBUG) {
-        char msg[80];
-        int off = 0;
-        off += snprintf(msg + off, sizeof(msg) - off, "BNO055: RX <-");
-        for (int i = 0; i < recv_count; ++i) off += snprintf(msg + off, sizeof(msg) - off, " %02X", recv_buf[i]);
-        task_print_info("%s", msg);
+    uint8_t packet[4 + BNO055_WRITE_MAX];
+    packet[0] = BNO_UART_START_BYTE;
+    packet[1] = BNO_UART_WRITE;
+    packet[2] = reg;
+    packet[3] = len;
+    memcpy(&packet[4], data, len);
+
+    if (BNO055_DEBUG) task_print_info("BNO055: TX -> [ %02X %02X %02X %02X %02X ... ]", packet[0], packet[1], packet[2], packet[3], packet[4]);
+
+    if (bno055_xfer_begin(packet, 4u + len, false, 0) != CY_RSLT_SUCCESS) {
+        if (bno_uart_mutex) xSemaphoreGive(bno_uart_mutex);
+        task_print_error("BNO055: UART TX failed (Reg: 0x%02X)", reg);
+        return CY_RSLT_TYPE_ERROR;
     }
 
-    for (int i = 0; i < recv_count; ++i) {
-        if (recv_buf[i] == 0xEE) {
-            if (i+1 < recv_count) {
-                if (recv_buf[i+1] == 0x01) return CY_RSLT_SUCCESS;
-                else { task_print_warning("BNO055: ACK found but status != 0x01 (0x%02X)", recv_buf[i+1]); return CY_RSLT_TYPE_ERROR; }
-            } else {
-                return CY_RSLT_SUCCESS;
-            }
-        }
+    bno055_xfer_result_t res = bno055_xfer_wait();
+
+    if (bno_uart_mutex) xSemaphoreGive(bno_uart_mutex);
+
+    if (res != BNO_XFER_DONE) {
+        if (xfer.state == BNO_RX_STATUS) task_print_warning("BNO055: ACK found but status != 0x01 (0x%02X)", xfer.status);
+        else task_print_error("BNO055: Write Timeout (Reg: 0x%02X) - no response", reg);
+        return CY_RSLT_TYPE_ERROR;
     }
 
-    task_print_error("BNO055: ACK not found in response");
-    return CY_RSLT_TYPE_ERROR;
+    return CY_RSLT_SUCCESS;
 }
 
-/* Helper: Read registers */
-static cy_rslt_t bno055_read_regs(uint8_t reg, uint8_t *buffer, uint8_t len)
+/* Helper: Write a single register */
+static cy_rslt_t bno055_write_reg(uint8_t reg, uint8_t data)
 {
-    if (bno_uart == NULL || buffer == NULL) return CY_RSLT_TYPE_ERROR;
+    return bno055_write_regs(reg, &data, 1);
+}
 
-    if (bno_uart_mutex) xSemaphoreTake(bno_uart_mutex, portMAX_DELAY);
+cy_rslt_t bno055_read_start(uint8_t reg, uint8_t len)
+{
+    if (bno_uart == NULL || len == 0 || len > sizeof(xfer.data)) return CY_RSLT_TYPE_ERROR;
 
-    cyhal_uart_clear(bno_uart);
+    if (bno_uart_mutex) xSemaphoreTake(bno_uart_mutex, portMAX_DELAY);
 
     uint8_t cmd[4];
     cmd[0] = BNO_UART_START_BYTE;
@@ -96,57 +237,68 @@ static cy_rslt_t bno055_read_regs(uint8_t reg, uint8_t *buffer, uint8_t len)
 
     if (BNO055_DEBUG) task_print_info("BNO055: TX(Read) -> %02X %02X %02X %02X", cmd[0], cmd[1], cmd[2], cmd[3]);
 
-    for (int i = 0; i < 4; ++i) {
-        if (cyhal_uart_putc(bno_uart, cmd[i]) != CY_RSLT_SUCCESS) {
-            if (bno_uart_mutex) xSemaphoreGive(bno_uart_mutex);
-            return CY_RSLT_TYPE_ERROR;
-        }
+    if (bno055_xfer_begin(cmd, sizeof(cmd), true, len) != CY_RSLT_SUCCESS) {
+        if (bno_uart_mutex) xSemaphoreGive(bno_uart_mutex);
+        return CY_RSLT_TYPE_ERROR;
     }
+    return CY_RSLT_SUCCESS;
+}
 
-    uint8_t header = 0;
-    {
-        const TickType_t hdr_deadline = xTaskGetTickCount() + pdMS_TO_TICKS(750);
-        bool got_header = false;
-        int skipped_count = 0;
-        while (xTaskGetTickCount() < hdr_deadline) {
-            cy_rslt_t rh = cyhal_uart_getc(bno_uart, &header, 50);
-            if (rh == CY_RSLT_SUCCESS) {
-                if (header == 0xBB) { got_header = true; break; }
-                skipped_count++;
-                if (BNO055_DEBUG) task_print_info("BNO055: Skipped byte while waiting for header: 0x%02X", header);
-                continue;
-            }
-        }
-        if (!got_header) {
-            //if (skipped_count > 0) task_print_warning("BNO055: Skipped %d bytes while waiting for header", skipped_count);
-            if (bno_uart_mutex) xSemaphoreGive(bno_uart_mutex);
-            //task_print_error("BNO055: No response header for read reg 0x%02X", reg);
-            return CY_RSLT_TYPE_ERROR;
-        }
-        if (skipped_count > 0 && BNO055_DEBUG) task_print_info("BNO055: Found header after skipping %d bytes", skipped_count);
+cy_rslt_t bno055_read_finish(uint8_t *buffer)
+{
+    bno055_xfer_result_t res = bno055_xfer_wait();
+
+    if (res == BNO_XFER_DONE && buffer != NULL) {
+        memcpy(buffer, xfer.data, xfer.expected_len);
     }
 
-    uint8_t reported_len = 0;
-    if (cyhal_uart_getc(bno_uart, &reported_len, 20) != CY_RSLT_SUCCESS) {
-        if (bno_uart_mutex) xSemaphoreGive(bno_uart_mutex);
+    if (bno_uart_mutex) xSemaphoreGive(bno_uart_mutex);
+
+    if (res != BNO_XFER_DONE) {
+        if (BNO055_DEBUG) task_print_info("BNO055: Read failed (state=%d status=0x%02X)", xfer.state, xfer.status);
         return CY_RSLT_TYPE_ERROR;
     }
+    return CY_RSLT_SUCCESS;
+}
 
-    for (int i = 0; i < len; ++i) {
-        uint8_t rx_byte = 0;
-        if (cyhal_uart_getc(bno_uart, &rx_byte, 50) != CY_RSLT_SUCCESS) {
-            if (bno_uart_mutex) xSemaphoreGive(bno_uart_mutex);
-            return CY_RSLT_TYPE_ERROR;
-        }
-        buffer[i] = rx_byte;
+/* Helper: Read registers, retrying on bus errors reported by the sensor */
+static cy_rslt_t bno055_read_regs(uint8_t reg, uint8_t *buffer, uint8_t len)
+{
+    if (buffer == NULL) return CY_RSLT_TYPE_ERROR;
+
+    cy_rslt_t rs = CY_RSLT_TYPE_ERROR;
+    for (int attempt = 0; attempt < BNO055_READ_RETRIES; ++attempt) {
+        rs = bno055_read_start(reg, len);
+        if (rs != CY_RSLT_SUCCESS) return rs;
+        rs = bno055_read_finish(buffer);
+        if (rs == CY_RSLT_SUCCESS) break;
     }
+    return rs;
+}
 
-    if (bno_uart_mutex) xSemaphoreGive(bno_uart_mutex);
-    if (BNO055_DEBUG) task_print_info("BNO055: Read resp: header=0x%02X len=%u data=%02X", header, reported_len, buffer[0]);
+/* Helper: Poll SYS_STATUS until fusion is running; a slow start is only a warning */
+static cy_rslt_t bno055_wait_fusion(uint32_t timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+    uint8_t status = 0, err = 0;
+
+    do {
+        if (bno055_read_regs(BNO055_SYS_STATUS_ADDR, &status, 1) == CY_RSLT_SUCCESS) {
+            if (status == BNO055_SYS_STATUS_FUSION) return CY_RSLT_SUCCESS;
+            if (status == BNO055_SYS_STATUS_ERROR) {
+                bno055_read_regs(BNO055_SYS_ERR_ADDR, &err, 1);
+                task_print_error("BNO055: System error 0x%02X", err);
+                return CY_RSLT_TYPE_ERROR;
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(1));
+    } while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(timeout_ms));
+
+    task_print_warning("BNO055: Fusion not running after %lu ms (status 0x%02X)", (unsigned long)timeout_ms, status);
     return CY_RSLT_SUCCESS;
 }
 
-cy_rslt_t bno055_init(cyhal_uart_t *uart_obj)
+cy_rslt_t bno055_init(cyhal_uart_t *uart_obj, const bno055_calib_t *calib)
 {
     bno_uart = uart_obj;
     uint8_t chip_id = 0;
@@ -157,47 +309,62 @@ cy_rslt_t bno055_init(cyhal_uart_t *uart_obj)
         if (bno_uart_mutex == NULL) return CY_RSLT_TYPE_ERROR;
     }
 
-    // 1. Verify Chip ID
+    /* Hand RX over to the interrupt-driven ring buffer */
+    rx_head = rx_tail = 0;
+    cyhal_uart_clear(bno_uart);
+    cyhal_uart_register_callback(bno_uart, bno055_uart_event_handler, NULL);
+    cyhal_uart_enable_event(bno_uart, CYHAL_UART_IRQ_RX_NOT_EMPTY, BNO055_UART_INT_PRIORITY, true);
+
+    // 1. Poll the Chip ID until the sensor answers (it is silent while booting)
     task_print_info("BNO055: Verifying Chip ID...");
+    TickType_t start = xTaskGetTickCount();
     bool id_found = false;
-    for (int i = 0; i < 4; i++) {
+    do {
         rs = bno055_read_regs(BNO055_CHIP_ID_ADDR, &chip_id, 1);
-        if (rs == CY_RSLT_SUCCESS && chip_id == 0xA0) {
+        if (rs == CY_RSLT_SUCCESS && chip_id == BNO055_CHIP_ID) {
             id_found = true;
-            task_print_info("BNO055: Chip ID OK (0xA0)");
             break;
         }
-        cyhal_system_delay_ms(200);
-    }
+        vTaskDelay(pdMS_TO_TICKS(BNO055_POLL_MS));
+    } while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(BNO055_BOOT_TIMEOUT_MS));
 
     if (!id_found) {
         task_print_error("BNO055: Failed to read ID (Got 0x%02X)", chip_id);
         return CY_RSLT_TYPE_ERROR;
     }
-
-    cyhal_system_delay_ms(50); 
-
-    // 2. Enter CONFIG mode
-    task_print_info("BNO055: Setting CONFIG Mode...");
-    rs = bno055_write_reg(BNO055_OPR_MODE_ADDR, OPERATION_MODE_CONFIG);
-    if (rs != CY_RSLT_SUCCESS) return rs;
-    
-    cyhal_system_delay_ms(50); 
+    task_print_info("BNO055: Chip ID OK (0xA0) after %lu ms", (unsigned long)(xTaskGetTickCount() - start));
+
+    // 2. Enter CONFIG mode (already there after a reset, so usually no switch)
+    uint8_t mode = 0xFF;
+    rs = bno055_read_regs(BNO055_OPR_MODE_ADDR, &mode, 1);
+    if (rs != CY_RSLT_SUCCESS || (mode & 0x0F) != OPERATION_MODE_CONFIG) {
+        task_print_info("BNO055: Setting CONFIG Mode...");
+        rs = bno055_write_reg(BNO055_OPR_MODE_ADDR, OPERATION_MODE_CONFIG);
+        if (rs != CY_RSLT_SUCCESS) return rs;
+        vTaskDelay(pdMS_TO_TICKS(BNO055_TO_CONFIG_MS));
+    }
 
     // 3. SKIP EXTERNAL CRYSTAL (Internal Oscillator)
     task_print_info("BNO055: Using Internal Oscillator");
 
-    // 4. Set NDOF Mode
+    // 4. Restore the saved calibration profile so fusion starts calibrated
+    if (calib != NULL) {
+        rs = bno055_write_regs(BNO055_CALIB_DATA_ADDR, (const uint8_t *)calib, BNO055_CALIB_DATA_LEN);
+        if (rs == CY_RSLT_SUCCESS) task_print_info("BNO055: Calibration profile restored");
+        else task_print_warning("BNO055: Calibration restore failed, starting uncalibrated");
+    }
+
+    // 5. Set NDOF Mode
     task_print_info("BNO055: Setting NDOF Mode...");
     rs = bno055_write_reg(BNO055_OPR_MODE_ADDR, OPERATION_MODE_NDOF);
     if (rs != CY_RSLT_SUCCESS) { 
         task_print_error("BNO055: Failed to set NDOF mode");
         return rs;
     } 
-    
-    cyhal_system_delay_ms(50); 
+    vTaskDelay(pdMS_TO_TICKS(BNO055_FROM_CONFIG_MS));
 
-    return CY_RSLT_SUCCESS;
+    // 6. Wait for SYS_STATUS to report the fusion running instead of a fixed delay
+    return bno055_wait_fusion(BNO055_FUSION_TIMEOUT_MS);
 }
 
 cy_rslt_t bno055_read_euler(bno055_vec3_t *euler)
@@ -213,3 +380,30 @@ cy_rslt_t bno055_read_euler(bno055_vec3_t *euler)
     return CY_RSLT_SUCCESS;
 }
 
+
+
+cy_rslt_t bno055_read_sample(bno055_sample_t *sample)
+{
+    if (sample == NULL) return CY_RSLT_TYPE_ERROR;
+
+    return bno055_read_regs(BNO055_SAMPLE_START_ADDR, (uint8_t *)sample, BNO055_SAMPLE_LEN);
+}
+
+cy_rslt_t bno055_read_calib(bno055_calib_t *calib)
+{
+    cy_rslt_t rs, rs_mode;
+
+    if (calib == NULL) return CY_RSLT_TYPE_ERROR;
+
+    rs = bno055_write_reg(BNO055_OPR_MODE_ADDR, OPERATION_MODE_CONFIG);
+    if (rs != CY_RSLT_SUCCESS) return rs;
+    vTaskDelay(pdMS_TO_TICKS(BNO055_TO_CONFIG_MS));
+
+    rs = bno055_read_regs(BNO055_CALIB_DATA_ADDR, (uint8_t *)calib, BNO055_CALIB_DATA_LEN);
+
+    /* Back to fusion even if the read failed */
+    rs_mode = bno055_write_reg(BNO055_OPR_MODE_ADDR, OPERATION_MODE_NDOF);
+    vTaskDelay(pdMS_TO_TICKS(BNO055_FROM_CONFIG_MS));
+
+    return (rs != CY_RSLT_SUCCESS) ? rs : rs_mode;
+}
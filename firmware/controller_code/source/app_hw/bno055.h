@@ -8,22 +8,69 @@
 #define BNO055_CHIP_ID_ADDR      0x00
 #define BNO055_OPR_MODE_ADDR     0x3D
 #define BNO055_SYS_TRIGGER_ADDR  0x3F
+#define BNO055_SYS_STATUS_ADDR   0x39
+#define BNO055_SYS_ERR_ADDR      0x3A
 #define BNO055_AXIS_MAP_CONFIG   0x41
 #define BNO055_AXIS_MAP_SIGN     0x42
 
 /* Data Registers */
 #define BNO055_ACCEL_DATA_X_LSB_ADDR 0x08
+#define BNO055_MAG_DATA_X_LSB_ADDR   0x0E
+#define BNO055_GYRO_DATA_X_LSB_ADDR  0x14
 #define BNO055_EULER_H_LSB_ADDR      0x1A
 #define BNO055_QUATERNION_DATA_W_LSB_ADDR 0x20
+#define BNO055_LINEAR_ACCEL_DATA_X_LSB_ADDR 0x28
+#define BNO055_GRAVITY_DATA_X_LSB_ADDR 0x2E
+#define BNO055_TEMP_ADDR             0x34
+#define BNO055_CALIB_STAT_ADDR       0x35
+
+/* Calibration: sensor offsets and radii, ACCEL_OFFSET_X_LSB .. MAG_RADIUS_MSB.
+   Only readable/writable in CONFIG mode */
+#define BNO055_CALIB_DATA_ADDR       0x55
+#define BNO055_CALIB_DATA_LEN        22
+
+/* Burst window covering every fusion output, ACCEL_DATA_X_LSB .. CALIB_STAT */
+#define BNO055_SAMPLE_START_ADDR     BNO055_ACCEL_DATA_X_LSB_ADDR
+#define BNO055_SAMPLE_LEN            (BNO055_CALIB_STAT_ADDR - BNO055_ACCEL_DATA_X_LSB_ADDR + 1)
 
 /* Operation Modes */
 #define OPERATION_MODE_CONFIG    0x00
 #define OPERATION_MODE_NDOF      0x0C
 
+#define BNO055_CHIP_ID           0xA0
+
+/* SYS_STATUS values */
+#define BNO055_SYS_STATUS_ERROR  0x01
+#define BNO055_SYS_STATUS_FUSION 0x05    /* Fusion algorithm running */
+
+/* Mode switch times (datasheet table 3-6) */
+#define BNO055_TO_CONFIG_MS      19
+#define BNO055_FROM_CONFIG_MS    7
+
+/* Readiness polling: reset to CONFIG mode is 650 ms typical, so the chip ID
+   is polled every BNO055_POLL_MS up to BNO055_BOOT_TIMEOUT_MS */
+#define BNO055_POLL_MS           10
+#define BNO055_BOOT_TIMEOUT_MS   1000
+#define BNO055_FUSION_TIMEOUT_MS 100
+
 /* UART Protocol Definitions */
 #define BNO_UART_START_BYTE      0xAA
 #define BNO_UART_WRITE           0x00
 #define BNO_UART_READ            0x01
+#define BNO_UART_READ_RESP       0xBB
+#define BNO_UART_ACK_RESP        0xEE
+#define BNO_UART_WRITE_SUCCESS   0x01
+
+/* UART Transport Configuration */
+#define BNO055_UART_BAUD         115200
+#define BNO055_UART_INT_PRIORITY 3
+#define BNO055_RX_RING_SIZE      256     /* Must be a power of 2, larger than the longest frame */
+#define BNO055_READ_RETRIES      3
+#define BNO055_WRITE_MAX         32      /* Longest multi-register write, keeps the frame inside the TX FIFO */
+
+/* Response deadline: sensor turnaround plus wire time for n bytes (10 bits/byte) */
+#define BNO055_RESP_LATENCY_MS   5
+#define BNO055_XFER_TIMEOUT_MS(n) (BNO055_RESP_LATENCY_MS + 1 + (((n) * 10u * 1000u) / BNO055_UART_BAUD))
 
 typedef struct {
     int16_t x;
@@ -38,13 +85,52 @@ typedef struct {
     int16_t z;
 } bno055_quat_t;
 
+/*
+ * One fusion sample, laid out exactly like registers 0x08-0x35 so the burst
+ * read can be copied in directly (both the sensor and the CM4 are little endian).
+ */
+typedef struct __attribute__((packed)) {
+    bno055_vec3_t accel;        /* 100 LSB = 1 m/s^2 */
+    bno055_vec3_t mag;          /* 16 LSB = 1 uT */
+    bno055_vec3_t gyro;         /* 16 LSB = 1 dps */
+    bno055_vec3_t euler;        /* 16 LSB = 1 degree (heading, roll, pitch) */
+    bno055_quat_t quat;         /* 2^14 LSB = 1 */
+    bno055_vec3_t linear_accel; /* 100 LSB = 1 m/s^2 */
+    bno055_vec3_t gravity;      /* 100 LSB = 1 m/s^2 */
+    int8_t temp;                /* 1 LSB = 1 degree C */
+    uint8_t calib_stat;         /* SYS[7:6] GYR[5:4] ACC[3:2] MAG[1:0], 3 = calibrated */
+} bno055_sample_t;
+
+_Static_assert(sizeof(bno055_sample_t) == BNO055_SAMPLE_LEN, "bno055_sample_t must match the register window");
+
+/* Calibration profile, laid out like registers 0x55-0x6A */
+typedef struct __attribute__((packed)) {
+    bno055_vec3_t accel_offset;
+    bno055_vec3_t mag_offset;
+    bno055_vec3_t gyro_offset;
+    int16_t accel_radius;
+    int16_t mag_radius;
+} bno055_calib_t;
+
+_Static_assert(sizeof(bno055_calib_t) == BNO055_CALIB_DATA_LEN, "bno055_calib_t must match the register window");
+
 /**
  * @brief Initialize the BNO055 over UART.
  * Configures the sensor to NDOF mode and enables the external crystal.
  * * @param uart_obj Pointer to the initialized PSoC UART object
+ * @param calib Saved calibration profile to restore before NDOF, or NULL
  * @return cy_rslt_t CY_RSLT_SUCCESS if initialized, error otherwise
  */
-cy_rslt_t bno055_init(cyhal_uart_t *uart_obj);
+cy_rslt_t bno055_init(cyhal_uart_t *uart_obj, const bno055_calib_t *calib);
+
+/**
+ * @brief Read the current calibration profile.
+ * Drops to CONFIG mode for the read and returns to NDOF, so fusion output
+ * pauses for roughly 30 ms. Only worth saving once CALIB_STAT reports
+ * IMU_CALIB_STAT_SENSORS.
+ * @param calib Pointer to struct to store the profile
+ */
+cy_rslt_t bno055_read_calib(bno055_calib_t *calib);
 
 /**
  * @brief Read Euler angles (Heading, Roll, Pitch)
@@ -52,6 +138,32 @@ cy_rslt_t bno055_init(cyhal_uart_t *uart_obj);
  */
 cy_rslt_t bno055_read_euler(bno055_vec3_t *euler);
 
+/**
+ * @brief Read every fusion output in a single UART transaction.
+ * Accel, mag, gyro, Euler, quaternion, linear accel, gravity, temperature
+ * and calibration status all come from one contiguous register burst.
+ * @param sample Pointer to struct to store data
+ */
+cy_rslt_t bno055_read_sample(bno055_sample_t *sample);
+
+/**
+ * @brief Start an asynchronous register read.
+ * Sends the read command and returns immediately; the RX interrupt collects
+ * the response. Must be paired with bno055_read_finish() from the same task.
+ * @param reg First register address
+ * @param len Number of registers to read (1-128)
+ */
+cy_rslt_t bno055_read_start(uint8_t reg, uint8_t len);
+
+/**
+ * @brief Complete a read started with bno055_read_start().
+ * Blocks on a task notification until the response frame is parsed or the
+ * wire-time deadline expires. The transport is free for the next request
+ * as soon as this returns.
+ * @param buffer Destination for the register data (len bytes)
+ */
+cy_rslt_t bno055_read_finish(uint8_t *buffer);
+
 #endif
 
 
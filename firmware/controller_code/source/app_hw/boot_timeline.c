@@ -0,0 +1,63 @@
+#include "boot_timeline.h"
+#include "timestamp.h"
+#include "FreeRTOS_CLI.h"
+#include <string.h>
+
+static boot_stage_t stages[BOOT_STAGE_MAX];
+static volatile uint8_t stage_count = 0;
+
+static BaseType_t cli_handler_boot(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+static const CLI_Command_Definition_t cmd_boot = {"boot", "\r\nboot\r\n", cli_handler_boot, 0};
+
+static int find_stage(const char *stage)
+{
+    for (uint8_t i = 0; i < stage_count; i++) {
+        if (strcmp(stages[i].stage, stage) == 0) return i;
+    }
+    return -1;
+}
+
+void boot_timeline_init(void)
+{
+    boot_mark("main");
+    FreeRTOS_CLIRegisterCommand(&cmd_boot);
+}
+
+void boot_mark(const char *stage)
+{
+    uint32_t now = timestamp_us();
+
+    taskENTER_CRITICAL();
+    if (stage_count < BOOT_STAGE_MAX && find_stage(stage) < 0) {
+        stages[stage_count].stage = stage;
+        stages[stage_count].time_us = now;
+        stage_count++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+uint32_t boot_stage_us(const char *stage)
+{
+    int i = find_stage(stage);
+    return (i < 0) ? 0 : stages[i].time_us;
+}
+
+/* One stage per call, the CLI keeps calling while pdTRUE is returned */
+static BaseType_t cli_handler_boot(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString)
+{
+    static uint8_t next = 0;
+    (void)pcCommandString;
+
+    if (next >= stage_count) {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "(%u stages)\r\n", stage_count);
+        next = 0;
+        return pdFALSE;
+    }
+
+    uint32_t prev = (next == 0) ? 0 : stages[next - 1].time_us;
+    snprintf(pcWriteBuffer, xWriteBufferLen, "%8lu.%03lu ms  +%6lu us  %s\r\n",
+             (unsigned long)(stages[next].time_us / 1000), (unsigned long)(stages[next].time_us % 1000),
+             (unsigned long)(stages[next].time_us - prev), stages[next].stage);
+    next++;
+    return pdTRUE;
+}
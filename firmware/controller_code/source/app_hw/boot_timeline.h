@@ -0,0 +1,36 @@
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include "main.h"
+
+/*
+ * Boot timeline: each init stage marks itself once with a timestamp_us()
+ * stamp, so boot time and time-to-first-gesture can be read back with the
+ * "boot" CLI command instead of guessed from the fixed delays.
+ */
+
+#define BOOT_STAGE_MAX          16
+
+typedef struct {
+    const char *stage;
+    uint32_t time_us;           /* Since timestamp_init() */
+} boot_stage_t;
+
+/**
+ * @brief Register the CLI command. Call from main after timestamp_init().
+ */
+void boot_timeline_init(void);
+
+/**
+ * @brief Record a stage. Only the first mark of a stage is kept, so it is
+ * safe to call from code that runs again later (e.g. on reconnect).
+ * @param stage String literal naming the stage
+ */
+void boot_mark(const char *stage);
+
+/**
+ * @brief Time a stage was reached in microseconds, 0 if it has not been.
+ */
+uint32_t boot_stage_us(const char *stage);
+
+#endif /* BOOT_TIMELINE_H */
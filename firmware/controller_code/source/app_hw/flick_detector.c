@@ -0,0 +1,92 @@
+#include "flick_detector.h"
+#include <stdlib.h>
+
+#define DEG16(d)    ((int32_t)(d) * 16)
+
+void flick_init(flick_detector_t *fd, uint16_t rate_hz)
+{
+    uint32_t confirm = ((uint32_t)FLICK_CONFIRM_MS * rate_hz + 999) / 1000;
+
+    fd->primed = false;
+    fd->armed = true;
+    fd->held = false;
+    fd->confirm = 0;
+    fd->confirm_needed = (confirm == 0) ? 1 : (uint8_t)confirm;
+    fd->candidate = GESTURE_NONE;
+    fd->rate_hz = rate_hz;
+    fd->lockout_until = 0;
+    fd->fired = 0;
+}
+
+void flick_lockout(flick_detector_t *fd, TickType_t now)
+{
+    fd->lockout_until = now + pdMS_TO_TICKS(FLICK_LOCKOUT_MS);
+    fd->held = false;
+}
+
+imu_gesture_t flick_update(flick_detector_t *fd, int16_t delta_roll, int16_t delta_pitch, TickType_t now)
+{
+    imu_gesture_t gesture = GESTURE_NONE;
+    int32_t rate_r, rate_p, abs_rate_r, abs_rate_p;
+
+    if (!fd->primed) {
+        fd->prev_roll = delta_roll;
+        fd->prev_pitch = delta_pitch;
+        fd->primed = true;
+        return GESTURE_NONE;
+    }
+
+    /* Angular velocity in 1/16 dps */
+    rate_r = ((int32_t)delta_roll - fd->prev_roll) * fd->rate_hz;
+    rate_p = ((int32_t)delta_pitch - fd->prev_pitch) * fd->rate_hz;
+    fd->prev_roll = delta_roll;
+    fd->prev_pitch = delta_pitch;
+    abs_rate_r = abs(rate_r);
+    abs_rate_p = abs(rate_p);
+
+    /* Nothing fires while a gesture is held or within the lockout after its release */
+    if (fd->held || (int32_t)(now - fd->lockout_until) < 0) {
+        fd->candidate = GESTURE_NONE;
+        fd->confirm = 0;
+        return GESTURE_NONE;
+    }
+
+    /* Hysteresis: re-arm only once the hand has slowed down */
+    if (!fd->armed) {
+        if (abs_rate_r < DEG16(FLICK_RATE_REARM_DPS) && abs_rate_p < DEG16(FLICK_RATE_REARM_DPS)) {
+            fd->armed = true;
+        }
+        return GESTURE_NONE;
+    }
+
+    /* Candidate: fast, one clear axis, and moving away from center */
+    if (abs_rate_p >= abs_rate_r) {
+        if (abs_rate_p > DEG16(FLICK_RATE_TRIGGER_DPS) && abs_rate_p > abs_rate_r * FLICK_DOMINANCE &&
+            abs(delta_pitch) > DEG16(FLICK_MIN_ANGLE_DEG) && (rate_p > 0) == (delta_pitch > 0)) {
+            gesture = (rate_p > 0) ? GESTURE_DOWN : GESTURE_UP;
+        }
+    } else {
+        if (abs_rate_r > DEG16(FLICK_RATE_TRIGGER_DPS) && abs_rate_r > abs_rate_p * FLICK_DOMINANCE &&
+            abs(delta_roll) > DEG16(FLICK_MIN_ANGLE_DEG) && (rate_r > 0) == (delta_roll > 0)) {
+            gesture = (rate_r > 0) ? GESTURE_RIGHT : GESTURE_LEFT;
+        }
+    }
+
+    if (gesture == GESTURE_NONE || gesture != fd->candidate) {
+        fd->candidate = gesture;
+        fd->confirm = (gesture == GESTURE_NONE) ? 0 : 1;
+    } else if (fd->confirm < UINT8_MAX) {
+        fd->confirm++;
+    }
+
+    if (fd->candidate != GESTURE_NONE && fd->confirm >= fd->confirm_needed) {
+        gesture = fd->candidate;
+        fd->candidate = GESTURE_NONE;
+        fd->confirm = 0;
+        fd->armed = false;
+        fd->held = true;
+        fd->fired++;
+        return gesture;
+    }
+    return GESTURE_NONE;
+}
@@ -0,0 +1,66 @@
+#ifndef FLICK_DETECTOR_H
+#define FLICK_DETECTOR_H
+
+#include "main.h"
+#include "task_imu.h"
+
+/*
+ * Flick detector: recognises a fast wrist flick from angular velocity on
+ * its rising edge, well before the tilt itself reaches THRESH_TRIGGER.
+ *
+ * Velocity is the per-sample change of the unfiltered roll/pitch, so it is
+ * in the same axes and signs as the tilt detector on every backend.
+ * A flick fires when, for FLICK_CONFIRM_MS:
+ *   - the dominant axis turns faster than FLICK_RATE_TRIGGER_DPS,
+ *   - it is FLICK_DOMINANCE times faster than the other axis, and
+ *   - the hand is already FLICK_MIN_ANGLE_DEG off center in that direction
+ *     (so the return stroke toward center never fires).
+ * After firing it stays quiet until the gesture is released, then for
+ * FLICK_LOCKOUT_MS, and re-arms only once both rates drop below
+ * FLICK_RATE_REARM_DPS. The lockout also follows tilt-started gestures so
+ * a return stroke never reads as a flick the other way.
+ */
+
+#define FLICK_RATE_TRIGGER_DPS  120
+#define FLICK_RATE_REARM_DPS    60
+#define FLICK_DOMINANCE         2
+#define FLICK_MIN_ANGLE_DEG     4
+#define FLICK_CONFIRM_MS        10
+#define FLICK_LOCKOUT_MS        200
+
+/* A flick-started gesture is held at least this long before it can release */
+#define FLICK_MIN_HOLD_MS       100
+
+typedef struct {
+    int16_t prev_roll;
+    int16_t prev_pitch;
+    bool primed;
+    bool armed;
+    bool held;                  /* Fired, waiting for flick_lockout() */
+    uint8_t confirm;            /* Consecutive samples agreeing on candidate */
+    uint8_t confirm_needed;
+    imu_gesture_t candidate;
+    uint16_t rate_hz;
+    TickType_t lockout_until;
+    uint32_t fired;             /* Flicks reported */
+} flick_detector_t;
+
+/**
+ * @brief Reset the detector for a given sample rate.
+ */
+void flick_init(flick_detector_t *fd, uint16_t rate_hz);
+
+/**
+ * @brief Feed one unfiltered sample, relative to the calibrated center.
+ * @param delta_roll Roll minus center, 1/16 degree
+ * @param delta_pitch Pitch minus center, 1/16 degree
+ * @return The gesture on flick onset, GESTURE_NONE otherwise
+ */
+imu_gesture_t flick_update(flick_detector_t *fd, int16_t delta_roll, int16_t delta_pitch, TickType_t now);
+
+/**
+ * @brief Start the lockout, call whenever a held gesture is released.
+ */
+void flick_lockout(flick_detector_t *fd, TickType_t now);
+
+#endif /* FLICK_DETECTOR_H */
@@ -11,10 +11,48 @@
 #include "imu.h"
 #include "cy_result.h"
 #include "cyhal_hw_types.h"
+#include <string.h>
 
 static cyhal_spi_t *IMU_spi_obj;
 static cyhal_gpio_t PIN_IMU_CS_N;
 
+static int32_t imu_platform_write(void *handle, uint8_t reg, const uint8_t *bufp, uint16_t len);
+static int32_t imu_platform_read(void *handle, uint8_t reg, uint8_t *bufp, uint16_t len);
+
+static stmdev_ctx_t imu_ctx = {
+    .write_reg = imu_platform_write,
+    .read_reg = imu_platform_read,
+    .mdelay = NULL,
+    .handle = NULL,
+};
+
+/* Scratch for burst reads: byte 0 is clocked in while the address goes out */
+static uint8_t spi_rx_buf[IMU_SPI_BURST_MAX + 1];
+
+/* FIFO State */
+static cyhal_gpio_callback_data_t int1_cb_data;
+static cyhal_gpio_t fifo_int1_pin = NC;
+static volatile TaskHandle_t fifo_waiter = NULL;
+static volatile bool fifo_int_pending = false;
+static uint16_t fifo_watermark_sets = 1;
+static imu_fifo_stats_t fifo_stats;
+
+/* Gyro sensitivity per full scale, LSM6DSM datasheet table 3 */
+static const struct {
+    uint16_t fs_dps;
+    uint32_t udps_per_lsb;
+} gyro_sens_table[] = {
+    { 125,   4375 },
+    { 250,   8750 },
+    { 500,  17500 },
+    { 1000, 35000 },
+    { 2000, 70000 },
+};
+
+/* Units per LSB for the full-scale ranges last programmed */
+static float accel_sens = ACCEL_SENS_2G;
+static float gyro_sens = 0.00875f;      /* ±250 dps */
+
 /**
  * @brief 
  * Read a register from the IMU
@@ -23,12 +61,7 @@ static cyhal_gpio_t PIN_IMU_CS_N;
  */
 void imu_write_reg(uint8_t reg, uint8_t value)
 {
-    uint8_t tx_data[2] = {reg & 0x7F, value};
-    uint8_t rx_data[2] = {0};
-
-    cyhal_gpio_write(PIN_IMU_CS_N, false);
-    cyhal_spi_transfer(IMU_spi_obj, tx_data, sizeof(tx_data), rx_data, sizeof(rx_data), 100);
-    cyhal_gpio_write(PIN_IMU_CS_N, true);
+    imu_platform_write(NULL, reg, &value, 1);
 }
 
 /**
@@ -39,33 +72,102 @@ void imu_write_reg(uint8_t reg, uint8_t value)
  */
 uint8_t imu_read_reg(uint8_t reg)
 {
-    uint8_t tx_data[2] = {reg | 0x80, 0x00};
-    uint8_t rx_data[2] = {0};
-
-    cyhal_gpio_write(PIN_IMU_CS_N, false);
-    cyhal_spi_transfer(IMU_spi_obj, tx_data, sizeof(tx_data), rx_data, sizeof(rx_data), 100);
-    cyhal_gpio_write(PIN_IMU_CS_N, true);
-
-    return rx_data[1];
+    uint8_t value = 0;
+    imu_platform_read(NULL, reg, &value, 1);
+    return value;
 }
 
 /**
  * @brief Read multiple registers from the IMU
- * 
+ * One SPI transaction; the LSM6DSM auto-increments the address (IF_INC),
+ * and wraps FIFO_DATA_OUT_H back to FIFO_DATA_OUT_L so the FIFO can be
+ * drained the same way.
+ *
  * @param reg 
  * @param buffer 
  * @param length 
  */
-void imu_read_registers(uint8_t reg, uint8_t *buffer, uint8_t length)
+void imu_read_registers(uint8_t reg, uint8_t *buffer, uint16_t length)
 {
     if (length == 0) {
         return;
     }
 
-    // Implement SPI read operation here
-    for (uint8_t i = 0; i < length; i++) {
-        buffer[i] = imu_read_reg(reg + i);
+    imu_platform_read(NULL, reg, buffer, length);
+}
+
+/**
+ * @brief ST driver write hook, auto-increment burst under the shared SPI lock
+ */
+static int32_t imu_platform_write(void *handle, uint8_t reg, const uint8_t *bufp, uint16_t len)
+{
+    uint8_t tx_data[8];
+    uint8_t rx_data[8];
+    (void)handle;
+
+    if (len == 0 || len > sizeof(tx_data) - 1) {
+        return -1;
     }
+
+    tx_data[0] = reg & 0x7F;
+    memcpy(&tx_data[1], bufp, len);
+
+    xSemaphoreTake(Semaphore_SPI, portMAX_DELAY);
+    cyhal_gpio_write(PIN_IMU_CS_N, false);
+    cy_rslt_t rslt = cyhal_spi_transfer(IMU_spi_obj, tx_data, len + 1, rx_data, len + 1, 0x00);
+    cyhal_gpio_write(PIN_IMU_CS_N, true);
+    xSemaphoreGive(Semaphore_SPI);
+
+    return (rslt == CY_RSLT_SUCCESS) ? 0 : -1;
+}
+
+/**
+ * @brief ST driver read hook, auto-increment burst under the shared SPI lock
+ */
+static int32_t imu_platform_read(void *handle, uint8_t reg, uint8_t *bufp, uint16_t len)
+{
+    uint8_t tx_data = reg | 0x80;
+    (void)handle;
+
+    if (len == 0 || len > IMU_SPI_BURST_MAX) {
+        return -1;
+    }
+
+    xSemaphoreTake(Semaphore_SPI, portMAX_DELAY);
+    cyhal_gpio_write(PIN_IMU_CS_N, false);
+    /* Only the address is sent, the rest of the clocks shift out the fill byte */
+    cy_rslt_t rslt = cyhal_spi_transfer(IMU_spi_obj, &tx_data, 1, spi_rx_buf, len + 1, 0x00);
+    cyhal_gpio_write(PIN_IMU_CS_N, true);
+    if (rslt == CY_RSLT_SUCCESS) {
+        memcpy(bufp, &spi_rx_buf[1], len);
+    }
+    xSemaphoreGive(Semaphore_SPI);
+
+    return (rslt == CY_RSLT_SUCCESS) ? 0 : -1;
+}
+
+stmdev_ctx_t *imu_get_ctx(void)
+{
+    return &imu_ctx;
+}
+
+/**
+ * @brief Gyro sensitivity at a full scale, from the datasheet rather than
+ * full scale / 32768
+ *
+ * @param fs_dps Full scale in dps (125 to 2000)
+ * @return µdps per LSB, 0 if the sensor has no such range
+ */
+uint32_t imu_gyro_udps_per_lsb(uint16_t fs_dps)
+{
+    for (uint8_t i = 0; i < sizeof(gyro_sens_table) / sizeof(gyro_sens_table[0]); i++)
+    {
+        if (gyro_sens_table[i].fs_dps == fs_dps)
+        {
+            return gyro_sens_table[i].udps_per_lsb;
+        }
+    }
+    return 0;
 }
 
 /**
@@ -94,12 +196,12 @@ void imu_read_accel_gyro(float *ax, float *ay, float *az, float *gx, float *gy,
     int16_t raw_az = (int16_t)(buffer[11] << 8 | buffer[10]);
 
     /* Convert to physical units */
-    *gx = raw_gx * GYRO_SENS_250DPS;
-    *gy = raw_gy * GYRO_SENS_250DPS;
-    *gz = raw_gz * GYRO_SENS_250DPS;
-    *ax = raw_ax * ACCEL_SENS_2G;
-    *ay = raw_ay * ACCEL_SENS_2G;
-    *az = raw_az * ACCEL_SENS_2G;
+    *gx = raw_gx * gyro_sens;
+    *gy = raw_gy * gyro_sens;
+    *gz = raw_gz * gyro_sens;
+    *ax = raw_ax * accel_sens;
+    *ay = raw_ay * accel_sens;
+    *az = raw_az * accel_sens;
 }
 
 /**
@@ -118,11 +220,17 @@ bool imu_init(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin)
     IMU_spi_obj = spi_obj;
     PIN_IMU_CS_N = cs_pin;
 
-    // Wait for 15mS after power-up
-    cyhal_system_delay_ms(15);
-
-    // Verify the WHO_AM_I register
-    uint8_t who_am_i = imu_read_reg(IMU_REG_WHO_AM_I);
+    // Poll WHO_AM_I until the sensor answers instead of a fixed 15mS wait
+    uint8_t who_am_i = 0;
+    for (uint8_t i = 0; i < IMU_BOOT_TIMEOUT_MS; i++)
+    {
+        who_am_i = imu_read_reg(IMU_REG_WHO_AM_I);
+        if (who_am_i == 0x6A)
+        {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
     if (who_am_i != 0x6A)
     {
         return false;
@@ -134,12 +242,201 @@ bool imu_init(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin)
     // Wait for the reset to complete
     do
     {
-        cyhal_system_delay_ms(1);
+        vTaskDelay(pdMS_TO_TICKS(1));
     } while (imu_read_reg(IMU_REG_CTRL3_C) & 0x01);
 
     // Configure the IMU:  104 Hz, ±2g, ±250 dps
     imu_write_reg(IMU_REG_CTRL1_XL, ODR_104HZ | FS_XL_2G);
     imu_write_reg(IMU_REG_CTRL2_G, ODR_104HZ | FS_G_250DPS);
+    accel_sens = ACCEL_SENS_2G;
+    gyro_sens = imu_gyro_udps_per_lsb(250) * 1e-6f;
 
     return true;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief INT1 (FIFO threshold) handler, wakes the task blocked in imu_fifo_wait()
+ */
+static void imu_int1_handler(void *handler_arg, cyhal_gpio_event_t event)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    (void)handler_arg;
+    (void)event;
+
+    fifo_stats.wakeups++;
+    fifo_int_pending = true;
+    if (fifo_waiter != NULL)
+    {
+        vTaskNotifyGiveFromISR(fifo_waiter, &xHigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * @brief Switch to FIFO-batched acquisition.
+ * Gyro and accel run at odr_hz (416 or 833) and are batched into the FIFO
+ * in stream mode. INT1 fires when odr_hz / IMU_FIFO_WAKE_HZ sets are
+ * waiting. Call after imu_init().
+ *
+ * @param odr_hz Output data rate, 416 or 833
+ * @param int1_pin MCU pin wired to LSM6DSM INT1
+ * @return true if the sensor accepted the configuration
+ */
+bool imu_fifo_init(uint16_t odr_hz, cyhal_gpio_t int1_pin)
+{
+    lsm6dsm_odr_xl_t odr_xl;
+    lsm6dsm_odr_g_t odr_g;
+    lsm6dsm_odr_fifo_t odr_fifo;
+    lsm6dsm_int1_route_t int1_route;
+    int32_t ret = 0;
+
+    switch (odr_hz)
+    {
+        case 416:
+            odr_xl = LSM6DSM_XL_ODR_416Hz; odr_g = LSM6DSM_GY_ODR_416Hz; odr_fifo = LSM6DSM_FIFO_416Hz;
+            break;
+        case 833:
+            odr_xl = LSM6DSM_XL_ODR_833Hz; odr_g = LSM6DSM_GY_ODR_833Hz; odr_fifo = LSM6DSM_FIFO_833Hz;
+            break;
+        default:
+            return false;
+    }
+
+    fifo_watermark_sets = odr_hz / IMU_FIFO_WAKE_HZ;
+    memset(&fifo_stats, 0, sizeof(fifo_stats));
+
+    /* Bypass mode empties the FIFO */
+    ret |= lsm6dsm_fifo_mode_set(&imu_ctx, LSM6DSM_BYPASS_MODE);
+    ret |= lsm6dsm_block_data_update_set(&imu_ctx, 1);
+    ret |= lsm6dsm_xl_full_scale_set(&imu_ctx, LSM6DSM_4g);
+    ret |= lsm6dsm_gy_full_scale_set(&imu_ctx, LSM6DSM_1000dps);
+    accel_sens = ACCEL_SENS_4G;
+    gyro_sens = imu_gyro_udps_per_lsb(IMU_FIFO_GYRO_FS_DPS) * 1e-6f;
+    ret |= lsm6dsm_xl_data_rate_set(&imu_ctx, odr_xl);
+    ret |= lsm6dsm_gy_data_rate_set(&imu_ctx, odr_g);
+
+    /* Batch both sensors at full rate, watermark is in 16-bit words */
+    ret |= lsm6dsm_fifo_xl_batch_set(&imu_ctx, LSM6DSM_FIFO_XL_NO_DEC);
+    ret |= lsm6dsm_fifo_gy_batch_set(&imu_ctx, LSM6DSM_FIFO_GY_NO_DEC);
+    ret |= lsm6dsm_fifo_watermark_set(&imu_ctx, fifo_watermark_sets * (IMU_FIFO_SET_BYTES / 2));
+    ret |= lsm6dsm_fifo_data_rate_set(&imu_ctx, odr_fifo);
+
+    /* Route only the FIFO threshold to INT1 */
+    memset(&int1_route, 0, sizeof(int1_route));
+    int1_route.int1_fth = 1;
+    ret |= lsm6dsm_pin_int1_route_set(&imu_ctx, int1_route);
+
+    if (ret != 0)
+    {
+        return false;
+    }
+
+    /* The pin only needs setting up once; rate changes just reprogram the sensor */
+    if (fifo_int1_pin != int1_pin)
+    {
+        if (cyhal_gpio_init(int1_pin, CYHAL_GPIO_DIR_INPUT, CYHAL_GPIO_DRIVE_NONE, false) != CY_RSLT_SUCCESS)
+        {
+            return false;
+        }
+        int1_cb_data.callback = imu_int1_handler;
+        int1_cb_data.callback_arg = NULL;
+        cyhal_gpio_register_callback(int1_pin, &int1_cb_data);
+        cyhal_gpio_enable_event(int1_pin, CYHAL_GPIO_IRQ_RISE, 3, true);
+        fifo_int1_pin = int1_pin;
+    }
+
+    return lsm6dsm_fifo_mode_set(&imu_ctx, LSM6DSM_STREAM_MODE) == 0;
+}
+
+/**
+ * @brief Block until INT1 reports the FIFO watermark.
+ * The timeout is a safety net for a missed edge; the caller should drain
+ * the FIFO either way.
+ *
+ * @return true if woken by INT1
+ */
+bool imu_fifo_wait(uint32_t timeout_ms)
+{
+    bool woken;
+
+    fifo_waiter = xTaskGetCurrentTaskHandle();
+    if (!fifo_int_pending)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms));
+    }
+    fifo_waiter = NULL;
+
+    woken = fifo_int_pending;
+    fifo_int_pending = false;
+    return woken;
+}
+
+/**
+ * @brief Drain complete gyro+accel sets from the FIFO in one SPI burst.
+ *
+ * @param samples Output array
+ * @param max_samples Capacity of samples
+ * @return Number of sets written to samples
+ */
+uint16_t imu_fifo_read(imu_raw_sample_t *samples, uint16_t max_samples)
+{
+    static uint8_t fifo_buf[IMU_SPI_BURST_MAX];
+    uint16_t words = 0;
+    uint16_t pattern = 0;
+    uint8_t overrun = 0;
+    uint16_t sets;
+
+    if (lsm6dsm_fifo_data_level_get(&imu_ctx, &words) != 0 ||
+        lsm6dsm_fifo_pattern_get(&imu_ctx, &pattern) != 0)
+    {
+        return 0;
+    }
+
+    if (lsm6dsm_fifo_over_run_get(&imu_ctx, &overrun) == 0 && overrun)
+    {
+        fifo_stats.overruns++;
+    }
+
+    /* The next word should be Gx; otherwise drop the rest of the partial set */
+    if (pattern != 0)
+    {
+        uint16_t skip = (IMU_FIFO_SET_BYTES / 2) - pattern;
+        if (skip > words)
+        {
+            return 0;
+        }
+        imu_read_registers(LSM6DSM_FIFO_DATA_OUT_L, fifo_buf, skip * 2);
+        words -= skip;
+        fifo_stats.realigns++;
+    }
+
+    sets = words / (IMU_FIFO_SET_BYTES / 2);
+    if (sets > max_samples) sets = max_samples;
+    if (sets > IMU_FIFO_MAX_SETS) sets = IMU_FIFO_MAX_SETS;
+    if (sets == 0)
+    {
+        return 0;
+    }
+
+    imu_read_registers(LSM6DSM_FIFO_DATA_OUT_L, fifo_buf, sets * IMU_FIFO_SET_BYTES);
+    fifo_stats.bursts++;
+
+    for (uint16_t i = 0; i < sets; i++)
+    {
+        const uint8_t *p = &fifo_buf[i * IMU_FIFO_SET_BYTES];
+        samples[i].gx = (int16_t)(p[1] << 8 | p[0]);
+        samples[i].gy = (int16_t)(p[3] << 8 | p[2]);
+        samples[i].gz = (int16_t)(p[5] << 8 | p[4]);
+        samples[i].ax = (int16_t)(p[7] << 8 | p[6]);
+        samples[i].ay = (int16_t)(p[9] << 8 | p[8]);
+        samples[i].az = (int16_t)(p[11] << 8 | p[10]);
+    }
+    fifo_stats.samples += sets;
+
+    return sets;
+}
+
+void imu_fifo_get_stats(imu_fifo_stats_t *stats)
+{
+    *stats = fifo_stats;
+}
@@ -19,6 +19,7 @@
 #include "cybsp.h"
 #include "cyhal_hw_types.h"
 #include "spi.h"
+#include "lsm6dsm_reg.h"
 
 #include <stdint.h>
 
@@ -35,14 +36,51 @@
 #define FS_XL_2G     0x00  // ±2g
 #define FS_G_250DPS  0x00  // ±250 dps
 
-// Conversion factors
+// Conversion factors. The accel matches full scale / 32768; the gyro does
+// not (35 mdps/LSB at ±1000 dps, not 30.5), see imu_gyro_udps_per_lsb()
 #define ACCEL_SENS_2G   (2.0f / 32768.0f)   // g/LSB
-#define GYRO_SENS_250DPS (250.0f / 32768.0f) // dps/LSB
+
+// FIFO acquisition: ±4g and ±1000 dps so fast flicks do not clip
+#define ACCEL_SENS_4G      (4.0f / 32768.0f)      // g/LSB
+#define IMU_FIFO_GYRO_FS_DPS    1000
+#define IMU_FIFO_ACCEL_FS_G     4
+
+#define IMU_FIFO_WAKE_HZ        100     // INT1 rate, watermark = ODR / this
+#define IMU_BOOT_TIMEOUT_MS     20      // Power-up to WHO_AM_I, 15mS max per datasheet
+#define IMU_FIFO_MAX_SETS       32      // Gyro+accel sets drained per SPI burst
+#define IMU_FIFO_SET_BYTES      12      // Gx Gy Gz XLx XLy XLz, 16 bits each
+#define IMU_SPI_BURST_MAX       (IMU_FIFO_MAX_SETS * IMU_FIFO_SET_BYTES)
+
+// One gyro + accel set from the FIFO, raw LSB
+typedef struct {
+    int16_t gx, gy, gz;
+    int16_t ax, ay, az;
+} imu_raw_sample_t;
+
+// FIFO health counters
+typedef struct {
+    uint32_t wakeups;       // INT1 watermark interrupts
+    uint32_t bursts;        // SPI burst reads
+    uint32_t samples;       // Sets delivered to the caller
+    uint32_t overruns;      // FIFO filled before it was drained
+    uint32_t realigns;      // Partial sets discarded to get back in pattern
+} imu_fifo_stats_t;
 
 bool imu_init(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin);
 void imu_write_reg(uint8_t reg, uint8_t value);
 uint8_t imu_read_reg(uint8_t reg);
-void imu_read_registers(uint8_t reg, uint8_t *buffer, uint8_t length);
+void imu_read_registers(uint8_t reg, uint8_t *buffer, uint16_t length);
 void imu_read_accel_gyro(float *ax, float *ay, float *az, float *gx, float *gy, float *gz);
 
+/* Datasheet gyro sensitivity at a full scale in dps, µdps per LSB. 0 if the sensor has no such range */
+uint32_t imu_gyro_udps_per_lsb(uint16_t fs_dps);
+
+/* ST driver context bound to this SPI interface */
+stmdev_ctx_t *imu_get_ctx(void);
+
+bool imu_fifo_init(uint16_t odr_hz, cyhal_gpio_t int1_pin);
+bool imu_fifo_wait(uint32_t timeout_ms);
+uint16_t imu_fifo_read(imu_raw_sample_t *samples, uint16_t max_samples);
+void imu_fifo_get_stats(imu_fifo_stats_t *stats);
+
 #endif
\ No newline at end of file
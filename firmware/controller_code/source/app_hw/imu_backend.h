@@ -0,0 +1,74 @@
+#ifndef IMU_BACKEND_H
+#define IMU_BACKEND_H
+
+#include "cyhal.h"
+#include "cybsp.h"
+#include "FreeRTOS.h"
+
+/*
+ * Sensor-independent IMU interface used by task_imu. Each backend owns its
+ * bus and reset/interrupt pins and hands back samples in one format, so the
+ * filter and gesture layers do not care which sensor is fitted.
+ */
+
+/* Normalized sample, in the BNO055 output units the gesture logic was tuned for */
+typedef struct {
+    int16_t heading;        /* 16 LSB = 1 degree (0 if the backend has no heading) */
+    int16_t roll;           /* 16 LSB = 1 degree */
+    int16_t pitch;          /* 16 LSB = 1 degree */
+    int16_t gyro_x;         /* 16 LSB = 1 dps */
+    int16_t gyro_y;
+    int16_t gyro_z;
+    int16_t quat[4];        /* w, x, y, z, 2^14 LSB = 1 */
+    uint8_t calib_stat;     /* BNO055 CALIB_STAT layout, 0xFF if not applicable */
+    TickType_t tick;        /* When the sample was read */
+} imu_sample_t;
+
+/* calib_stat with gyro, accel and mag all at 3 (system status ignored) */
+#define IMU_CALIB_STAT_SENSORS  0x3F
+
+/* Largest sensor calibration profile any backend persists */
+#define IMU_CALIB_BLOB_MAX      22
+
+/* Identifies whose calibration profile a saved record holds */
+#define IMU_BACKEND_ID_BNO055   0x01
+#define IMU_BACKEND_ID_LSM6DSM  0x02
+
+typedef struct {
+    const char *name;
+    uint8_t id;
+
+    /* Sensor calibration profile size in bytes, 0 if the sensor has none */
+    uint8_t calib_len;
+
+    /* Bring up bus and sensor, called once from the IMU task.
+       calib is a profile from read_calib() to restore, or NULL */
+    cy_rslt_t (*init)(const uint8_t *calib);
+
+    /* Copy the sensor's current calibration profile (calib_len bytes). NULL = none */
+    cy_rslt_t (*read_calib)(uint8_t *calib);
+
+    /* Latest sample; if wait_data_ready is set, call it first */
+    cy_rslt_t (*read_sample)(imu_sample_t *sample);
+
+    /* Request a sensor rate; *out_hz is how often read_sample() has new data */
+    cy_rslt_t (*set_rate)(uint16_t rate_hz, uint16_t *out_hz);
+
+    /* Data-ready hook: block until the sensor has data. NULL = caller polls at out_hz */
+    bool (*wait_data_ready)(uint32_t timeout_ms);
+} imu_backend_t;
+
+extern const imu_backend_t imu_backend_bno055;
+
+/* Only with real pins, see imu_backend_lsm6dsm.c */
+#if defined(LSM6DSM_PIN_CS_N) && defined(LSM6DSM_PIN_INT1)
+#define IMU_BACKEND_HAS_LSM6DSM
+extern const imu_backend_t imu_backend_lsm6dsm;
+#endif
+
+/* Backend fitted on this hardware revision */
+#ifndef IMU_BACKEND_DEFAULT
+#define IMU_BACKEND_DEFAULT     imu_backend_bno055
+#endif
+
+#endif /* IMU_BACKEND_H */
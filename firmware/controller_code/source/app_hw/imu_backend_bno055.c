@@ -0,0 +1,76 @@
+#include "imu_backend.h"
+#include "bno055.h"
+#include "ece453_pins.h"
+#include "task.h"
+
+/* NDOF fusion output rate, the sensor cannot go faster */
+#define BNO055_FUSION_RATE_HZ   100
+
+static cyhal_uart_t bno_uart_obj;
+
+_Static_assert(sizeof(bno055_calib_t) <= IMU_CALIB_BLOB_MAX, "BNO055 calibration profile does not fit");
+
+static cy_rslt_t bno_backend_init(const uint8_t *calib)
+{
+    cy_rslt_t rslt;
+    uint32_t baud;
+
+    /* Hardware Reset; bno055_init() polls until the sensor has booted */
+    cyhal_gpio_write(MOD_1_PIN_IO_IMU_nRESET, false);
+    vTaskDelay(pdMS_TO_TICKS(1));
+    cyhal_gpio_write(MOD_1_PIN_IO_IMU_nRESET, true);
+
+    const cyhal_uart_cfg_t uart_config = {
+        .data_bits = 8, .stop_bits = 1, .parity = CYHAL_UART_PARITY_NONE, .rx_buffer = NULL, .rx_buffer_size = 0
+    };
+    rslt = cyhal_uart_init(&bno_uart_obj, MOD_1_PIN_UART_IMU_TX, MOD_1_PIN_UART_IMU_RX, NC, NC, NULL, &uart_config);
+    if (rslt != CY_RSLT_SUCCESS) return rslt;
+    cyhal_uart_set_baud(&bno_uart_obj, BNO055_UART_BAUD, &baud);
+
+    return bno055_init(&bno_uart_obj, (const bno055_calib_t *)calib);
+}
+
+static cy_rslt_t bno_backend_read_calib(uint8_t *calib)
+{
+    return bno055_read_calib((bno055_calib_t *)calib);
+}
+
+static cy_rslt_t bno_backend_read_sample(imu_sample_t *sample)
+{
+    bno055_sample_t raw;
+    cy_rslt_t rslt = bno055_read_sample(&raw);
+    if (rslt != CY_RSLT_SUCCESS) return rslt;
+
+    sample->heading = raw.euler.x;
+    sample->roll    = raw.euler.y;
+    sample->pitch   = raw.euler.z;
+    sample->gyro_x  = raw.gyro.x;
+    sample->gyro_y  = raw.gyro.y;
+    sample->gyro_z  = raw.gyro.z;
+    sample->quat[0] = raw.quat.w;
+    sample->quat[1] = raw.quat.x;
+    sample->quat[2] = raw.quat.y;
+    sample->quat[3] = raw.quat.z;
+    sample->calib_stat = raw.calib_stat;
+    sample->tick    = xTaskGetTickCount();
+    return CY_RSLT_SUCCESS;
+}
+
+/* Fusion runs at a fixed 100 Hz, so this only bounds how often it is polled */
+static cy_rslt_t bno_backend_set_rate(uint16_t rate_hz, uint16_t *out_hz)
+{
+    if (rate_hz == 0) return CY_RSLT_TYPE_ERROR;
+    *out_hz = (rate_hz > BNO055_FUSION_RATE_HZ) ? BNO055_FUSION_RATE_HZ : rate_hz;
+    return CY_RSLT_SUCCESS;
+}
+
+const imu_backend_t imu_backend_bno055 = {
+    .name = "bno055",
+    .id = IMU_BACKEND_ID_BNO055,
+    .calib_len = sizeof(bno055_calib_t),
+    .init = bno_backend_init,
+    .read_calib = bno_backend_read_calib,
+    .read_sample = bno_backend_read_sample,
+    .set_rate = bno_backend_set_rate,
+    .wait_data_ready = NULL,    /* No data-ready interrupt in NDOF mode */
+};
@@ -0,0 +1,116 @@
+#include "imu_backend.h"
+
+/*
+ * LSM6DSM board revision: the sensor sits on the module 1 SPI bus. No
+ * board file assigns its chip select or INT1 yet, so the backend is only
+ * built once the board's pins are given, e.g. in the Makefile:
+ *   DEFINES+=LSM6DSM_PIN_CS_N=<pin> LSM6DSM_PIN_INT1=<pin>
+ */
+#ifdef IMU_BACKEND_HAS_LSM6DSM
+
+#include "imu.h"
+#include "spi.h"
+#include "ece453_pins.h"
+#include "attitude_fusion.h"
+
+#define LSM6DSM_DEFAULT_ODR_HZ  833
+
+/* Mounting: sign of each tilt axis relative to the BNO055 orientation */
+#define LSM6DSM_ROLL_SIGN       (-1)
+#define LSM6DSM_PITCH_SIGN      (1)
+
+static imu_raw_sample_t fifo_samples[IMU_FIFO_MAX_SETS];
+static imu_raw_sample_t last_sample;
+static bool have_sample = false;
+
+/* Roll/pitch are fused on the MCU from every FIFO sample */
+static attitude_t attitude;
+
+/* Raw gyro to 1/16 dps in Q8, from the datasheet sensitivity at the FIFO
+   full scale: 35 mdps/LSB at ±1000 dps gives 143 */
+static int32_t gyro_dps16_q8;
+
+static int16_t gyro_to_dps16(int16_t raw)
+{
+    return (int16_t)(((int32_t)raw * gyro_dps16_q8) / 256);
+}
+
+/* Gyro bias is tracked by the fusion at runtime, nothing to restore */
+static cy_rslt_t lsm_backend_init(const uint8_t *calib)
+{
+    uint32_t gyro_sens;
+
+    (void)calib;
+    if (!imu_init(&mSPI, LSM6DSM_PIN_CS_N)) return CY_RSLT_TYPE_ERROR;
+    if (!imu_fifo_init(LSM6DSM_DEFAULT_ODR_HZ, LSM6DSM_PIN_INT1)) return CY_RSLT_TYPE_ERROR;
+    gyro_sens = imu_gyro_udps_per_lsb(IMU_FIFO_GYRO_FS_DPS);
+    gyro_dps16_q8 = (int32_t)((gyro_sens * 16 * 256 + 500000) / 1000000);
+    attitude_init(&attitude, LSM6DSM_DEFAULT_ODR_HZ, gyro_sens, IMU_FIFO_ACCEL_FS_G);
+    have_sample = false;
+    return CY_RSLT_SUCCESS;
+}
+
+static cy_rslt_t lsm_backend_read_sample(imu_sample_t *sample)
+{
+    int16_t roll, pitch;
+    int32_t q[4];
+    uint16_t count = imu_fifo_read(fifo_samples, IMU_FIFO_MAX_SETS);
+
+    /* Every set goes through the fusion, not just the newest */
+    for (uint16_t i = 0; i < count; i++) {
+        const imu_raw_sample_t *s = &fifo_samples[i];
+        attitude_update(&attitude, s->gx, s->gy, s->gz, s->ax, s->ay, s->az);
+    }
+    if (count > 0) {
+        last_sample = fifo_samples[count - 1];
+        have_sample = true;
+    }
+    if (!have_sample) return CY_RSLT_TYPE_ERROR;
+
+    attitude_get_tilt(&attitude, &roll, &pitch);
+
+    sample->heading = 0;
+    sample->roll    = LSM6DSM_ROLL_SIGN * roll;
+    sample->pitch   = LSM6DSM_PITCH_SIGN * pitch;
+    sample->gyro_x  = gyro_to_dps16(last_sample.gx);
+    sample->gyro_y  = gyro_to_dps16(last_sample.gy);
+    sample->gyro_z  = gyro_to_dps16(last_sample.gz);
+
+    /* Q30 to the BNO055's Q14, in the sensor frame (no mounting signs) */
+    attitude_get_quat(&attitude, q);
+    for (uint8_t i = 0; i < 4; i++) {
+        sample->quat[i] = (int16_t)((q[i] + (1L << 15)) >> 16);
+    }
+    sample->calib_stat = 0xFF;
+    sample->tick    = xTaskGetTickCount();
+    return CY_RSLT_SUCCESS;
+}
+
+/*
+ * Samples are delivered once per FIFO watermark (IMU_FIFO_WAKE_HZ). A rate
+ * above that selects the sensor ODR (416 or 833); at or below it the ODR
+ * is left alone.
+ */
+static cy_rslt_t lsm_backend_set_rate(uint16_t rate_hz, uint16_t *out_hz)
+{
+    if (rate_hz > IMU_FIFO_WAKE_HZ) {
+        uint16_t odr = (rate_hz > 416) ? 833 : 416;
+        if (!imu_fifo_init(odr, LSM6DSM_PIN_INT1)) return CY_RSLT_TYPE_ERROR;
+        attitude_set_rate(&attitude, odr);
+    }
+    *out_hz = IMU_FIFO_WAKE_HZ;
+    return CY_RSLT_SUCCESS;
+}
+
+const imu_backend_t imu_backend_lsm6dsm = {
+    .name = "lsm6dsm",
+    .id = IMU_BACKEND_ID_LSM6DSM,
+    .calib_len = 0,
+    .init = lsm_backend_init,
+    .read_sample = lsm_backend_read_sample,
+    .read_calib = NULL,
+    .set_rate = lsm_backend_set_rate,
+    .wait_data_ready = imu_fifo_wait,
+};
+
+#endif /* IMU_BACKEND_HAS_LSM6DSM */
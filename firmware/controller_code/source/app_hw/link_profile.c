@@ -0,0 +1,167 @@
+#include "link_profile.h"
+#include "timestamp.h"
+#include "cycfg_gap.h"
+#include "wiced_timer.h"
+#include <string.h>
+
+static const uint16_t link_intervals[] = LINK_INTERVALS;
+#define LINK_INTERVAL_STEPS     (sizeof(link_intervals) / sizeof(link_intervals[0]))
+
+static link_profile_t profile;
+static uint16_t link_conn_id = 0;
+static wiced_bt_device_address_t link_bd_addr;
+static uint32_t link_connected_us = 0;
+static bool interval_requested = false;     /* An update from this side is pending */
+static wiced_timer_t grace_timer;
+static bool grace_timer_ready = false;
+
+static void request_interval(void);
+
+/* Helper: Fall back to the next interval, or keep the current one */
+static void next_interval(void)
+{
+    if (profile.interval_step + 1u < LINK_INTERVAL_STEPS) {
+        profile.interval_step++;
+        request_interval();
+    } else {
+        interval_requested = false;
+        profile.refused |= LINK_REFUSED_INTERVAL;
+    }
+}
+
+static void request_interval(void)
+{
+    uint16_t interval = link_intervals[profile.interval_step];
+
+    interval_requested = true;
+    if (!wiced_bt_l2cap_update_ble_conn_params(link_bd_addr, interval, interval, LINK_LATENCY,
+                                               LINK_SUPERVISION_TIMEOUT)) {
+        next_interval();
+    }
+}
+
+/* The central never updated the link, ask for the interval from here.
+   Once it has, its choice stands (it relaxes the link while the game is idle).
+   A stack timer, so this runs in the stack thread like the events that
+   update profile */
+static void grace_timer_callback(WICED_TIMER_PARAM_TYPE param)
+{
+    (void)param;
+    if (link_conn_id == 0) return;
+    if (profile.interval == 0) request_interval();
+}
+
+bool link_profile_init(void)
+{
+    grace_timer_ready = (wiced_init_timer(&grace_timer, grace_timer_callback, 0, WICED_MILLI_SECONDS_TIMER) == WICED_SUCCESS);
+    return grace_timer_ready;
+}
+
+void link_profile_connected(uint16_t conn_id, const wiced_bt_device_address_t bd_addr)
+{
+    wiced_bt_ble_phy_preferences_t phy;
+
+    memset(&profile, 0, sizeof(profile));
+    profile.mtu = LINK_DEFAULT_MTU;
+    profile.tx_phy = LINK_PHY_1M;
+    profile.rx_phy = LINK_PHY_1M;
+    profile.max_tx_octets = LINK_DEFAULT_OCTETS;
+    profile.max_rx_octets = LINK_DEFAULT_OCTETS;
+    link_conn_id = conn_id;
+    memcpy(link_bd_addr, bd_addr, BD_ADDR_LEN);
+    link_connected_us = timestamp_us();
+    interval_requested = false;
+
+    memset(&phy, 0, sizeof(phy));
+    memcpy(phy.remote_bd_addr, bd_addr, BD_ADDR_LEN);
+    phy.tx_phys = BTM_BLE_PREFER_2M_PHY;
+    phy.rx_phys = BTM_BLE_PREFER_2M_PHY;
+    if (wiced_bt_ble_set_phy(&phy) != WICED_BT_SUCCESS) {
+        profile.refused |= LINK_REFUSED_PHY;
+    }
+
+    if (wiced_bt_ble_set_data_packet_length(link_bd_addr, LINK_DLE_TX_OCTETS, LINK_DLE_TX_TIME_US) != WICED_BT_SUCCESS) {
+        profile.refused |= LINK_REFUSED_DLE;
+    }
+
+    if (grace_timer_ready) wiced_start_timer(&grace_timer, LINK_CENTRAL_GRACE_MS);
+}
+
+void link_profile_disconnected(void)
+{
+    link_conn_id = 0;
+    profile.interval = 0;
+    interval_requested = false;
+    if (grace_timer_ready) wiced_stop_timer(&grace_timer);
+}
+
+uint16_t link_profile_mtu_request(uint16_t remote_mtu)
+{
+    profile.mtu = (remote_mtu < CY_BT_MTU_SIZE) ? remote_mtu : CY_BT_MTU_SIZE;
+    if (profile.mtu <= LINK_DEFAULT_MTU) {
+        profile.mtu = LINK_DEFAULT_MTU;
+        profile.refused |= LINK_REFUSED_MTU;
+    }
+    profile.settle_us = timestamp_us() - link_connected_us;
+    return CY_BT_MTU_SIZE;
+}
+
+void link_profile_mgmt_event(wiced_bt_management_evt_t event, wiced_bt_management_evt_data_t *p_event_data)
+{
+    if (link_conn_id == 0) return;
+
+    switch (event)
+    {
+        case BTM_BLE_CONNECTION_PARAM_UPDATE:
+        {
+            wiced_bt_ble_connection_param_update_t *p = &p_event_data->ble_connection_param_update;
+            if (memcmp(p->bd_addr, link_bd_addr, BD_ADDR_LEN) != 0) return;
+
+            if (p->status == 0) {
+                profile.interval = p->conn_interval;
+                profile.latency = p->conn_latency;
+                profile.supervision_timeout = p->supervision_timeout;
+            }
+            /* Only our own requests step down, the central's choices are its own */
+            if (interval_requested) {
+                if (p->status != 0 || p->conn_interval > link_intervals[profile.interval_step]) next_interval();
+                else interval_requested = false;
+            }
+            break;
+        }
+
+        case BTM_BLE_PHY_UPDATE_EVT:
+        {
+            wiced_bt_ble_phy_update_t *p = &p_event_data->ble_phy_update_event;
+            if (memcmp(p->bd_addr, link_bd_addr, BD_ADDR_LEN) != 0) return;
+
+            if (p->status == 0) {
+                profile.tx_phy = p->tx_phy;
+                profile.rx_phy = p->rx_phy;
+            }
+            if (p->status != 0 || p->tx_phy != LINK_PHY_2M) profile.refused |= LINK_REFUSED_PHY;
+            break;
+        }
+
+        case BTM_BLE_DATA_LENGTH_UPDATE_EVENT:
+        {
+            wiced_bt_ble_data_length_update_t *p = &p_event_data->ble_data_length_update_event;
+            if (memcmp(p->bd_addr, link_bd_addr, BD_ADDR_LEN) != 0) return;
+
+            profile.max_tx_octets = p->max_tx_octets;
+            profile.max_rx_octets = p->max_rx_octets;
+            if (p->max_tx_octets <= LINK_DEFAULT_OCTETS) profile.refused |= LINK_REFUSED_DLE;
+            break;
+        }
+
+        default:
+            return;
+    }
+
+    profile.settle_us = timestamp_us() - link_connected_us;
+}
+
+void link_profile_get(link_profile_t *out)
+{
+    *out = profile;
+}
@@ -0,0 +1,87 @@
+#ifndef LINK_PROFILE_H
+#define LINK_PROFILE_H
+
+#include "main.h"
+#include "wiced_bt_dev.h"
+#include "wiced_bt_ble.h"
+#include "wiced_bt_gatt.h"
+
+/*
+ * Link profile manager, peripheral side. The console (central) drives the
+ * connection interval and MTU exchange; this side answers the MTU request,
+ * asks for 2M PHY and LE data length extension itself, and keeps what was
+ * agreed. If the central has not updated the connection parameters within
+ * LINK_CENTRAL_GRACE_MS (e.g. an older console), the interval is requested
+ * from here through L2CAP, stepping down the list when refused. Refused
+ * requests leave the link as it was.
+ */
+
+/* Connection intervals tried in order, 1.25 ms units (7.5, 10, 15 ms) */
+#define LINK_INTERVALS              { 6, 8, 12 }
+#define LINK_LATENCY                0
+#define LINK_SUPERVISION_TIMEOUT    100     /* 10 ms units */
+#define LINK_CENTRAL_GRACE_MS       1000
+
+#define LINK_DEFAULT_MTU            23      /* ATT default, before the exchange */
+#define LINK_DEFAULT_OCTETS         27      /* LL payload without DLE */
+#define LINK_DLE_TX_OCTETS          251
+#define LINK_DLE_TX_TIME_US         2120    /* 251 bytes at 1M, so either PHY works */
+
+/* PHY as reported by the link layer */
+#define LINK_PHY_1M                 1
+#define LINK_PHY_2M                 2
+
+/* Requests the peer turned down */
+#define LINK_REFUSED_INTERVAL       0x01    /* Every step of LINK_INTERVALS (our own requests) */
+#define LINK_REFUSED_PHY            0x02
+#define LINK_REFUSED_DLE            0x04
+#define LINK_REFUSED_MTU            0x08    /* Central kept the default */
+
+typedef struct {
+    uint16_t interval;              /* 1.25 ms units, 0 = unknown / not connected */
+    uint16_t latency;
+    uint16_t supervision_timeout;   /* 10 ms units */
+    uint16_t mtu;
+    uint8_t tx_phy;                 /* LINK_PHY_x */
+    uint8_t rx_phy;
+    uint16_t max_tx_octets;
+    uint16_t max_rx_octets;
+    uint8_t interval_step;          /* Index into LINK_INTERVALS last requested from here */
+    uint8_t refused;                /* LINK_REFUSED_x */
+    uint32_t settle_us;             /* Connection to the last update, from timestamp_us() */
+} link_profile_t;
+
+/**
+ * @brief Create the fallback timer. Call once on BTM_ENABLED_EVT, every
+ * other call comes from the stack's callbacks too.
+ */
+bool link_profile_init(void);
+
+/**
+ * @brief Start negotiating. Call from GATT_CONNECTION_STATUS_EVT.
+ */
+void link_profile_connected(uint16_t conn_id, const wiced_bt_device_address_t bd_addr);
+
+/**
+ * @brief Forget the link. Call on disconnect.
+ */
+void link_profile_disconnected(void);
+
+/**
+ * @brief Answer a GATT_REQ_MTU.
+ * @return The MTU to reply with (the local maximum); records the agreed one
+ */
+uint16_t link_profile_mtu_request(uint16_t remote_mtu);
+
+/**
+ * @brief Feed management events; connection parameter, PHY and data length
+ * updates are consumed, everything else is ignored.
+ */
+void link_profile_mgmt_event(wiced_bt_management_evt_t event, wiced_bt_management_evt_data_t *p_event_data);
+
+/**
+ * @brief Copy the negotiated values.
+ */
+void link_profile_get(link_profile_t *profile);
+
+#endif /* LINK_PROFILE_H */
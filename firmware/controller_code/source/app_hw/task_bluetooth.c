@@ -5,6 +5,12 @@
 #include "task_motor.h"
 #include "task_button.h"
 #include "task_console.h"
+#include "boot_timeline.h"
+#include "link_profile.h"
+#include "ble_bond.h"
+#include "timestamp.h"
+#include "FreeRTOS_CLI.h"
+#include "wiced_timer.h"
 
 /* Stack Includes */
 #include "cybsp.h"
@@ -16,104 +22,225 @@
 #include "cycfg_gap.h"
 #include "cycfg_gatt_db.h"
 
-/* --- TIMING CONFIGURATION --- */
-#define LOOP_DELAY_MS       50      /* Task update rate (20Hz) */
+#define CMD_ID_MOTOR        0x01
+#define CMD_ID_CALIB        0x02
+#define CMD_ID_MODE         0x03    /* [CMD_ID_MODE, REPORT_MODE_x], sent by the console after connecting */
 
-/* ADJUSTED SPEED: 350ms = approx 2.8 moves per second */
-#define REPEAT_DELAY_MS     275   
+/* Report modes: discrete sends 1-byte gestures, analog adds tilt packets */
+#define REPORT_MODE_DISCRETE    0x00
+#define REPORT_MODE_ANALOG      0x01
 
-/* Convert to ticks */
-#define REPEAT_TICKS        (REPEAT_DELAY_MS / LOOP_DELAY_MS)
+/* Analog packet: [NOTIFY_TYPE_TILT, int8 roll, int8 pitch], degrees from center.
+   The marker is outside the gesture range so 1-byte gestures stay unambiguous */
+#define NOTIFY_TYPE_TILT        0xA0
+#define NOTIFY_TILT_LEN         3
 
-#define CMD_ID_MOTOR        0x01
-#define CMD_ID_CALIB        0x02
+/* Gesture packet v2, little endian. Consoles that predate it only know the
+   1-byte form, which is the gesture code on its own */
+#define NOTIFY_TYPE_GESTURE     0xB0
+#define NOTIFY_VERSION          2
+#define NOTIFY_FLAG_REPEAT      0x01    /* Auto-repeat of a held gesture */
+#define NOTIFY_FLAG_BUTTON      0x02    /* Button held when the packet was built */
+
+typedef struct __attribute__((packed)) {
+    uint8_t type;               /* NOTIFY_TYPE_GESTURE */
+    uint8_t version;            /* NOTIFY_VERSION, fields are only ever appended */
+    uint8_t gesture;            /* imu_gesture_t */
+    uint8_t flags;              /* NOTIFY_FLAG_x */
+    uint16_t seq;               /* Per connection, +1 per gesture packet built */
+    uint32_t timestamp_us;      /* Controller timestamp_us() of the detection */
+} notify_gesture_t;
+
+/* Payload of one notification with the default MTU */
+#define NOTIFY_MAX_LEN          (LINK_DEFAULT_MTU - 3)
+
+_Static_assert(sizeof(notify_gesture_t) <= NOTIFY_MAX_LEN, "Gesture packet does not fit the default MTU");
+
+/* Advertised manufacturer data: [company lo, hi, ADV_DATA_DB_HASH, hash].
+   The console caches the GATT handles it discovers under this hash, so it
+   can skip discovery until the database changes. Flags and the name take
+   15 of the 31 bytes, this element 13 */
+#define ADV_COMPANY_ID          0xFFFF  /* Reserved for testing, no SIG company ID */
+#define ADV_DATA_DB_HASH        0x01
+#define ADV_DB_HASH_LEN         8       /* Leading bytes of the GATT database hash */
+
+/* After a link loss (and at power-on) the bonded console gets high duty
+   directed advertising, which it answers within a few ms if it is still in
+   range. The link layer gives up on it after 1.28 s; then anyone may
+   connect, e.g. a console that lost the bond */
+#define ADV_DIRECTED_MS         1300
+
+/* The stack keeps the payload until GATT_APP_BUFFER_TRANSMITTED_EVT, so
+   packets live in a small pool instead of on the sender's stack */
+#define NOTIFY_POOL_LEN         4
+
+typedef struct {
+    uint32_t sent;
+    uint32_t failed;            /* Refused by the stack */
+    uint32_t no_buffer;         /* Pool empty, packet dropped */
+} notify_stats_t;
+
+static uint8_t notify_pool[NOTIFY_POOL_LEN][NOTIFY_MAX_LEN];
+static volatile uint8_t notify_pool_used = 0;   /* Bit per pool entry */
+static notify_stats_t notify_stats;
+static uint16_t notify_seq = 0;
+
+typedef struct {
+    uint32_t directed;          /* Directed advertising started */
+    uint32_t fallbacks;         /* ... and the console did not answer in time */
+    uint32_t reconnect_us;      /* Link loss to the next connection, last */
+    uint32_t reconnect_max_us;
+} adv_stats_t;
 
 static uint16_t connection_id = 0;
 static bool notify_enabled = false;
+static bool bonded = false;
+static volatile bool adv_directed = false;
+static uint32_t link_lost_us = 0;           /* 0 until the first link loss */
+static adv_stats_t adv_stats;
+static wiced_timer_t adv_timer;             /* Stack timer, fires in the stack thread */
+static bool adv_timer_ready = false;
+static volatile uint8_t report_mode = REPORT_MODE_DISCRETE;
 
-/* State Tracking */
-static imu_gesture_t last_gesture_state = GESTURE_NONE;
-static uint32_t hold_timer = 0;
+static wiced_bt_db_hash_t db_hash;
+static uint8_t adv_db_hash_data[3 + ADV_DB_HASH_LEN];
+static wiced_bt_ble_advert_elem_t adv_elems[CY_BT_ADV_PACKET_DATA_SIZE + 1];
 
 /* Prototypes */
 static void ble_task(void *arg);
-static void send_notification(uint8_t gesture_val);
+static void send_notification(const gesture_event_t *evt);
+static void send_tilt_notification(int8_t roll, int8_t pitch);
+static bool send_packet(const void *packet, uint16_t len);
+static void notify_buffer_free(uint8_t *buffer);
+static void set_report_mode(uint8_t mode);
+static void set_advertisement_data(void);
+static void start_advertising(void);
+static void adv_timer_callback(WICED_TIMER_PARAM_TYPE param);
 static wiced_bt_dev_status_t app_bt_management_callback(wiced_bt_management_evt_t event, wiced_bt_management_evt_data_t *p_event_data);
 static wiced_bt_gatt_status_t app_gatt_callback(wiced_bt_gatt_evt_t event, wiced_bt_gatt_event_data_t *p_data);
 static wiced_bt_gatt_status_t app_gatt_attr_write_handler(uint16_t conn_id, wiced_bt_gatt_opcode_t opcode, wiced_bt_gatt_write_req_t *p_write_req);
 static wiced_bt_gatt_status_t app_gatt_attr_read_handler(uint16_t conn_id, wiced_bt_gatt_opcode_t opcode, wiced_bt_gatt_read_t *p_read_req, uint16_t len_requested);
 
+static BaseType_t cli_handler_ble(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+static const CLI_Command_Definition_t cmd_ble = {"ble", "\r\nble\r\n", cli_handler_ble, 0};
+
 void task_bluetooth_init(void) {
+    FreeRTOS_CLIRegisterCommand(&cmd_ble);
     xTaskCreate(ble_task, "BLE Task", 4096, NULL, configMAX_PRIORITIES - 2, NULL);
 }
 
 void ble_task(void *arg)
 {
     (void)arg;
+    bool first_gesture_marked = false;
+
+    /* Before the stack starts: it asks for the keys as soon as it is up */
+    bonded = ble_bond_load();
+    task_print_info("BLE: %s", bonded ? "Bonded console" : "No bond");
+
     cybt_platform_config_init(&cybsp_bt_platform_cfg);
     wiced_bt_stack_init(app_bt_management_callback, &wiced_bt_cfg_settings);
 
+    /* Gesture transitions arrive from task_imu as they happen; auto-repeat
+       ticks come from its repeat timer, so there is nothing to poll here */
     for(;;)
     {
-        /* Only run logic if connected and enabled */
-        if (connection_id != 0 && notify_enabled)
-        {
-            imu_data_t data;
-            task_imu_get_data(&data);
+        gesture_event_t evt;
+        if (xQueueReceive(q_gesture_events, &evt, portMAX_DELAY) != pdPASS) continue;
 
-            /* GESTURE LOGIC */
-            if (data.gesture != GESTURE_NONE)
-            {
-                /* CASE 1: New Gesture (Rising Edge) */
-                if (data.gesture != last_gesture_state)
-                {
-                    /* Send IMMEDIATE 1st packet */
-                    send_notification((uint8_t)data.gesture);
-                    
-                    /* Reset timer */
-                    hold_timer = 0; 
-                }
-                /* CASE 2: Holding Same Gesture */
-                else
-                {
-                    hold_timer++;
-                    
-                    /* Check if we reached the CONSTANT threshold */
-                    if (hold_timer >= REPEAT_TICKS)
-                    {
-                        /* Send Repeat Packet */
-                        send_notification((uint8_t)data.gesture);
-                        
-                        /* Reset timer */
-                        hold_timer = 0;
-                    }
-                }
-            }
-            else
+        /* Only notify if connected and enabled */
+        if (connection_id == 0 || !notify_enabled) continue;
+
+        /* Press sends the IMMEDIATE 1st packet, Repeat sends the held gesture
+           again, Release has no packet in this protocol */
+        if (evt.type == GESTURE_EVT_PRESS || evt.type == GESTURE_EVT_REPEAT)
+        {
+            send_notification(&evt);
+            if (!first_gesture_marked)
             {
-                /* Idle: Reset everything */
-                hold_timer = 0;
+                first_gesture_marked = true;
+                boot_mark("ble first gesture sent");
             }
-            
-            /* Update History */
-            last_gesture_state = data.gesture;
         }
-        else
+        else if (evt.type == GESTURE_EVT_TILT && report_mode == REPORT_MODE_ANALOG)
         {
-            /* Not connected: Reset state */
-            last_gesture_state = GESTURE_NONE;
-            hold_timer = 0;
+            send_tilt_notification(evt.tilt_roll, evt.tilt_pitch);
         }
-        
-        /* Loop Delay (Frequency of checks) */
-        vTaskDelay(pdMS_TO_TICKS(LOOP_DELAY_MS));
     }
 }
 
-static void send_notification(uint8_t gesture_val)
+/* The sequence number advances even if the send fails, so the console counts it as lost */
+static void send_notification(const gesture_event_t *evt)
+{
+    notify_gesture_t packet = {
+        .type = NOTIFY_TYPE_GESTURE,
+        .version = NOTIFY_VERSION,
+        .gesture = (uint8_t)evt->gesture,
+        .flags = ((evt->type == GESTURE_EVT_REPEAT) ? NOTIFY_FLAG_REPEAT : 0) |
+                 (g_btn_pressed ? NOTIFY_FLAG_BUTTON : 0),
+        .seq = notify_seq++,
+        .timestamp_us = evt->timestamp_us,
+    };
+    send_packet(&packet, sizeof(packet));
+}
+
+static void send_tilt_notification(int8_t roll, int8_t pitch)
+{
+    uint8_t packet[NOTIFY_TILT_LEN] = { NOTIFY_TYPE_TILT, (uint8_t)roll, (uint8_t)pitch };
+    send_packet(packet, NOTIFY_TILT_LEN);
+}
+
+/* Helper: Copy into a free pool entry and hand it to the stack */
+static bool send_packet(const void *packet, uint16_t len)
 {
-    uint8_t packet[1] = { gesture_val };
-    wiced_bt_gatt_server_send_notification(connection_id, HDLC_SENSOR_DATA_VALUE, 1, packet, NULL);
+    uint8_t slot;
+    wiced_bt_gatt_status_t status;
+
+    taskENTER_CRITICAL();
+    for (slot = 0; slot < NOTIFY_POOL_LEN; slot++) {
+        if ((notify_pool_used & (1u << slot)) == 0) {
+            notify_pool_used |= (1u << slot);
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (slot == NOTIFY_POOL_LEN) {
+        notify_stats.no_buffer++;
+        return false;
+    }
+
+    memcpy(notify_pool[slot], packet, len);
+    status = wiced_bt_gatt_server_send_notification(connection_id, HDLC_SENSOR_DATA_VALUE, len,
+                                                    notify_pool[slot], (void *)notify_buffer_free);
+    if (status != WICED_BT_GATT_SUCCESS) {
+        notify_buffer_free(notify_pool[slot]);
+        notify_stats.failed++;
+        return false;
+    }
+    notify_stats.sent++;
+    return true;
+}
+
+/* Called for GATT_APP_BUFFER_TRANSMITTED_EVT, or directly if the send failed */
+static void notify_buffer_free(uint8_t *buffer)
+{
+    for (uint8_t slot = 0; slot < NOTIFY_POOL_LEN; slot++) {
+        if (buffer == notify_pool[slot]) {
+            taskENTER_CRITICAL();
+            notify_pool_used &= ~(1u << slot);
+            taskEXIT_CRITICAL();
+            return;
+        }
+    }
+}
+
+/* Discrete is the default and what every connection starts in */
+static void set_report_mode(uint8_t mode)
+{
+    if (mode != REPORT_MODE_ANALOG) mode = REPORT_MODE_DISCRETE;
+    report_mode = mode;
+    task_imu_set_tilt_stream(mode == REPORT_MODE_ANALOG);
 }
 
 /* --- BOILERPLATE CALLBACKS (Unchanged) --- */
@@ -122,6 +249,7 @@ static wiced_bt_gatt_status_t app_gatt_attr_write_handler(uint16_t conn_id, wice
 {
     if (p_write_req->handle == HDLD_SENSOR_DATA_CLIENT_CHAR_CONFIG) {
         notify_enabled = (p_write_req->p_val[0] & GATT_CLIENT_CONFIG_NOTIFICATION) ? true : false;
+        if (notify_enabled) boot_mark("ble notify enabled");
         task_print_info("BLE: Notifications %s", notify_enabled ? "Enabled" : "Disabled");
     }
     else if (p_write_req->handle == HDLC_SENSOR_COMMAND_VALUE) {
@@ -137,17 +265,114 @@ static wiced_bt_gatt_status_t app_gatt_attr_write_handler(uint16_t conn_id, wice
         else if (p_write_req->p_val[0] == CMD_ID_CALIB) {
             task_imu_req_calibration();
         }
+        else if (p_write_req->val_len >= 2 && p_write_req->p_val[0] == CMD_ID_MODE) {
+            set_report_mode(p_write_req->p_val[1]);
+            task_print_info("BLE: %s mode", (report_mode == REPORT_MODE_ANALOG) ? "Analog" : "Discrete");
+        }
     }
     if (opcode == GATT_REQ_WRITE) wiced_bt_gatt_server_send_write_rsp(conn_id, opcode, p_write_req->handle);
     return WICED_BT_GATT_SUCCESS;
 }
 
+/* Generated advertisement plus the database hash */
+static void set_advertisement_data(void)
+{
+    memcpy(adv_elems, cy_bt_adv_packet_data, sizeof(wiced_bt_ble_advert_elem_t) * CY_BT_ADV_PACKET_DATA_SIZE);
+
+    adv_db_hash_data[0] = ADV_COMPANY_ID & 0xFF;
+    adv_db_hash_data[1] = ADV_COMPANY_ID >> 8;
+    adv_db_hash_data[2] = ADV_DATA_DB_HASH;
+    memcpy(&adv_db_hash_data[3], db_hash, ADV_DB_HASH_LEN);
+
+    adv_elems[CY_BT_ADV_PACKET_DATA_SIZE].advert_type = BTM_BLE_ADVERT_TYPE_MANUFACTURER;
+    adv_elems[CY_BT_ADV_PACKET_DATA_SIZE].len = sizeof(adv_db_hash_data);
+    adv_elems[CY_BT_ADV_PACKET_DATA_SIZE].p_data = adv_db_hash_data;
+
+    wiced_bt_ble_set_raw_advertisement_data(CY_BT_ADV_PACKET_DATA_SIZE + 1, adv_elems);
+}
+
+/* Directed to the bonded console if there is one, undirected otherwise */
+static void start_advertising(void)
+{
+    wiced_bt_device_address_t peer;
+    wiced_bt_ble_address_type_t peer_type;
+
+    if (ble_bond_peer(peer, &peer_type) &&
+        wiced_bt_start_advertisements(BTM_BLE_ADVERT_DIRECTED_HIGH, peer_type, peer) == WICED_BT_SUCCESS) {
+        adv_directed = true;
+        adv_stats.directed++;
+        if (adv_timer_ready) wiced_start_timer(&adv_timer, ADV_DIRECTED_MS);
+        return;
+    }
+    adv_directed = false;
+    wiced_bt_start_advertisements(BTM_BLE_ADVERT_UNDIRECTED_HIGH, BLE_ADDR_PUBLIC, NULL);
+}
+
+/* The console did not answer the directed advertising: off, out of range or
+   unpaired. Runs in the stack thread, so it cannot race the management
+   callback starting or stopping advertising */
+static void adv_timer_callback(WICED_TIMER_PARAM_TYPE param)
+{
+    (void)param;
+    if (connection_id != 0 || !adv_directed) return;
+
+    adv_directed = false;
+    adv_stats.fallbacks++;
+    wiced_bt_start_advertisements(BTM_BLE_ADVERT_UNDIRECTED_HIGH, BLE_ADDR_PUBLIC, NULL);
+}
+
 static wiced_bt_dev_status_t app_bt_management_callback(wiced_bt_management_evt_t event, wiced_bt_management_evt_data_t *p_event_data) {
-    if(event == BTM_ENABLED_EVT) {
-        wiced_bt_gatt_register(app_gatt_callback);
-        wiced_bt_gatt_db_init(gatt_database, gatt_database_len, NULL);
-        wiced_bt_ble_set_raw_advertisement_data(CY_BT_ADV_PACKET_DATA_SIZE, cy_bt_adv_packet_data);
-        wiced_bt_start_advertisements(BTM_BLE_ADVERT_UNDIRECTED_HIGH, BLE_ADDR_PUBLIC, NULL);
+    switch (event) {
+        case BTM_ENABLED_EVT:
+            boot_mark("ble stack enabled");
+            wiced_bt_gatt_register(app_gatt_callback);
+            wiced_bt_gatt_db_init(gatt_database, gatt_database_len, db_hash);
+            if (!link_profile_init()) task_print_error("Link profile timer not created");
+            adv_timer_ready = (wiced_init_timer(&adv_timer, adv_timer_callback, 0, WICED_MILLI_SECONDS_TIMER) == WICED_SUCCESS);
+            if (!adv_timer_ready) task_print_error("Advertising timer not created");
+            ble_bond_stack_ready();
+            set_advertisement_data();
+            start_advertising();
+            boot_mark("ble advertising");
+            break;
+
+        /* Just Works, bonded, so the console's identity is kept */
+        case BTM_PAIRING_IO_CAPABILITIES_BLE_REQUEST_EVT:
+            p_event_data->pairing_io_capabilities_ble_request.local_io_cap = BTM_IO_CAPABILITIES_NONE;
+            p_event_data->pairing_io_capabilities_ble_request.oob_data = BTM_OOB_NONE;
+            p_event_data->pairing_io_capabilities_ble_request.auth_req = BTM_LE_AUTH_REQ_BOND;
+            p_event_data->pairing_io_capabilities_ble_request.max_key_size = 16;
+            p_event_data->pairing_io_capabilities_ble_request.init_keys = BTM_LE_KEY_PENC | BTM_LE_KEY_PID;
+            p_event_data->pairing_io_capabilities_ble_request.resp_keys = BTM_LE_KEY_PENC | BTM_LE_KEY_PID;
+            break;
+
+        case BTM_SECURITY_REQUEST_EVT:
+            wiced_bt_ble_security_grant(p_event_data->security_request.bd_addr, WICED_BT_SUCCESS);
+            break;
+
+        case BTM_PAIRING_COMPLETE_EVT:
+            task_print_info("BLE: Pairing %s", (p_event_data->pairing_complete.pairing_complete_info.ble.status == 0) ?
+                                               "complete" : "failed");
+            break;
+
+        case BTM_PAIRED_DEVICE_LINK_KEYS_UPDATE_EVT:
+            ble_bond_keys_update(&p_event_data->paired_device_link_keys_update);
+            bonded = true;
+            break;
+
+        case BTM_PAIRED_DEVICE_LINK_KEYS_REQUEST_EVT:
+            return ble_bond_keys_request(&p_event_data->paired_device_link_keys_request) ? WICED_BT_SUCCESS : WICED_BT_ERROR;
+
+        case BTM_LOCAL_IDENTITY_KEYS_UPDATE_EVT:
+            ble_bond_identity_update(&p_event_data->local_identity_keys_update);
+            break;
+
+        case BTM_LOCAL_IDENTITY_KEYS_REQUEST_EVT:
+            return ble_bond_identity_request(&p_event_data->local_identity_keys_request) ? WICED_BT_SUCCESS : WICED_BT_ERROR;
+
+        default:
+            link_profile_mgmt_event(event, p_event_data);
+            break;
     }
     return WICED_BT_SUCCESS;
 }
@@ -156,21 +381,78 @@ static wiced_bt_gatt_status_t app_gatt_callback(wiced_bt_gatt_evt_t event, wiced
     if (event == GATT_CONNECTION_STATUS_EVT) {
         if(p_data->connection_status.connected) {
             connection_id = p_data->connection_status.conn_id;
+            boot_mark("ble connected");
+            notify_seq = 0;
             notify_enabled = true;
+            adv_directed = false;
+            if (adv_timer_ready) wiced_stop_timer(&adv_timer);
+            if (link_lost_us != 0) {
+                adv_stats.reconnect_us = timestamp_us() - link_lost_us;
+                if (adv_stats.reconnect_us > adv_stats.reconnect_max_us) adv_stats.reconnect_max_us = adv_stats.reconnect_us;
+            }
+            link_profile_connected(connection_id, p_data->connection_status.bd_addr);
+
+            /* A new console: pair in the background, notifications do not wait for it */
+            if (!ble_bond_is_peer(p_data->connection_status.bd_addr)) {
+                wiced_bt_dev_sec_bond(p_data->connection_status.bd_addr, p_data->connection_status.addr_type,
+                                      BT_TRANSPORT_LE, 0, NULL);
+            }
         } else {
             connection_id = 0;
+            link_lost_us = timestamp_us();
+            link_profile_disconnected();
             notify_enabled = false;
-            wiced_bt_start_advertisements(BTM_BLE_ADVERT_UNDIRECTED_HIGH, BLE_ADDR_PUBLIC, NULL);
+            set_report_mode(REPORT_MODE_DISCRETE);
+            start_advertising();
         }
     } else if (event == GATT_ATTRIBUTE_REQUEST_EVT) {
         if (p_data->attribute_request.opcode == GATT_REQ_WRITE || p_data->attribute_request.opcode == GATT_CMD_WRITE)
             return app_gatt_attr_write_handler(p_data->attribute_request.conn_id, p_data->attribute_request.opcode, &p_data->attribute_request.data.write_req);
         else if (p_data->attribute_request.opcode == GATT_REQ_READ)
             return app_gatt_attr_read_handler(p_data->attribute_request.conn_id, p_data->attribute_request.opcode, &p_data->attribute_request.data.read_req, p_data->attribute_request.len_requested);
+        else if (p_data->attribute_request.opcode == GATT_REQ_MTU)
+            return wiced_bt_gatt_server_send_mtu_rsp(p_data->attribute_request.conn_id, p_data->attribute_request.data.remote_mtu,
+                                                     link_profile_mtu_request(p_data->attribute_request.data.remote_mtu));
+    } else if (event == GATT_APP_BUFFER_TRANSMITTED_EVT) {
+        void (*free_fn)(uint8_t *) = (void (*)(uint8_t *))p_data->buffer_xmitted.p_app_ctxt;
+        if (free_fn != NULL) free_fn(p_data->buffer_xmitted.p_app_data);
     }
     return WICED_BT_GATT_SUCCESS;
 }
 
 static wiced_bt_gatt_status_t app_gatt_attr_read_handler(uint16_t conn_id, wiced_bt_gatt_opcode_t opcode, wiced_bt_gatt_read_t *p_read_req, uint16_t len_requested) {
     return wiced_bt_gatt_server_send_read_handle_rsp(conn_id, opcode, 0, NULL, NULL);
-}
\ No newline at end of file
+}
+
+/* One line per call, the CLI output buffer only holds configCOMMAND_INT_MAX_OUTPUT_SIZE */
+static BaseType_t cli_handler_ble(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString)
+{
+    static uint8_t line = 0;
+    link_profile_t profile;
+
+    (void)pcCommandString;
+    switch (line) {
+        case 0:
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Conn %u seq %u sent %lu failed %lu no-buffer %lu\r\n",
+                     connection_id, notify_seq, (unsigned long)notify_stats.sent,
+                     (unsigned long)notify_stats.failed, (unsigned long)notify_stats.no_buffer);
+            break;
+
+        case 1:
+            link_profile_get(&profile);
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Int %u lat %u phy %u/%u mtu %u oct %u/%u refused 0x%02x settle %lu ms\r\n",
+                     profile.interval, profile.latency, profile.tx_phy, profile.rx_phy, profile.mtu,
+                     profile.max_tx_octets, profile.max_rx_octets, profile.refused,
+                     (unsigned long)(profile.settle_us / 1000));
+            break;
+
+        default:
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Bond %s directed %lu fallbacks %lu reconnect %lu/%lu ms\r\n",
+                     bonded ? "yes" : "no", (unsigned long)adv_stats.directed, (unsigned long)adv_stats.fallbacks,
+                     (unsigned long)(adv_stats.reconnect_us / 1000), (unsigned long)(adv_stats.reconnect_max_us / 1000));
+            line = 0;
+            return pdFALSE;
+    }
+    line++;
+    return pdTRUE;
+}
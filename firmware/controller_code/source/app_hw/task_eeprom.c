@@ -10,6 +10,9 @@ static cyhal_gpio_t eeprom_cs_pin = NC;
 
 QueueHandle_t Queue_EEPROM_Requests;
 
+/* How long a request waits for room in Queue_EEPROM_Requests */
+#define EEPROM_REQUEST_TIMEOUT_MS   1000
+
 /* Forward declarations */
 static BaseType_t cli_handler_eeprom(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
 
@@ -37,8 +40,7 @@ static BaseType_t cli_handler_eeprom(char *pcWriteBuffer, size_t xWriteBufferLen
     char param_buffer[16];
 
     eeprom_message_t request;
-    eeprom_message_t response;
-    QueueHandle_t rsp_queue = NULL;
+    uint8_t read_value;
 
     // Clear output buffer
     memset(pcWriteBuffer, 0, xWriteBufferLen);
@@ -72,39 +74,13 @@ static BaseType_t cli_handler_eeprom(char *pcWriteBuffer, size_t xWriteBufferLen
             return pdFALSE;
         }
 
-        // Create response queue
-        rsp_queue = xQueueCreate(1, sizeof(eeprom_message_t));
-        if (rsp_queue == NULL) {
-            snprintf(pcWriteBuffer, xWriteBufferLen, "Failed to create response queue\r\n");
-            return pdFALSE;
-        }
-
-        request.command = EEPROM_CMD_READ_DATA;
-        request.address = addr;
-        request.length = 1;
-        request.data = NULL;
-        request.response_queue = rsp_queue;
-
-        if (xQueueSend(Queue_EEPROM_Requests, &request, pdMS_TO_TICKS(1000)) != pdPASS) {
-            snprintf(pcWriteBuffer, xWriteBufferLen, "Failed to send EEPROM request\r\n");
-            vQueueDelete(rsp_queue);
-            return pdFALSE;
-        }
-
-        if (xQueueReceive(rsp_queue, &response, pdMS_TO_TICKS(5000)) != pdPASS) {
-            snprintf(pcWriteBuffer, xWriteBufferLen, "EEPROM read timeout\r\n");
-            vQueueDelete(rsp_queue);
+        if (!task_eeprom_read(addr, &read_value, 1)) {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "EEPROM read failed\r\n");
             return pdFALSE;
         }
 
         snprintf(pcWriteBuffer, xWriteBufferLen, "EEPROM[0x%04X] = 0x%02X\r\n", 
-                addr, response.data[0]);
-        
-        // Clean up
-        if (response.data) {
-            vPortFree(response.data);
-        }
-        vQueueDelete(rsp_queue);
+                addr, read_value);
     }
     else if (strncmp(param, "write", param_len) == 0) {
         // Get address
@@ -180,6 +156,71 @@ static BaseType_t cli_handler_eeprom(char *pcWriteBuffer, size_t xWriteBufferLen
     return pdFALSE;
 }
 
+/* ============================= Requests ============================= */
+bool task_eeprom_read(uint16_t address, uint8_t *data, uint16_t length)
+{
+    eeprom_message_t request;
+    eeprom_message_t response;
+    QueueHandle_t rsp_queue = xQueueCreate(1, sizeof(eeprom_message_t));
+
+    if (rsp_queue == NULL) {
+        return false;
+    }
+
+    request.command = EEPROM_CMD_READ_DATA;
+    request.address = address;
+    request.data = data;
+    request.length = length;
+    request.response_queue = rsp_queue;
+
+    if (xQueueSend(Queue_EEPROM_Requests, &request, pdMS_TO_TICKS(EEPROM_REQUEST_TIMEOUT_MS)) != pdPASS) {
+        vQueueDelete(rsp_queue);
+        return false;
+    }
+
+    /* No timeout: the EEPROM task holds the queue until it answers, and it
+       answers every read */
+    xQueueReceive(rsp_queue, &response, portMAX_DELAY);
+    vQueueDelete(rsp_queue);
+    return response.length == length;
+}
+
+bool task_eeprom_write(uint16_t address, const uint8_t *data, uint16_t length, TickType_t ticks_to_wait)
+{
+    eeprom_message_t request;
+    uint8_t *copy = pvPortMalloc(length);
+
+    if (copy == NULL) {
+        return false;
+    }
+    memcpy(copy, data, length);
+
+    request.command = EEPROM_CMD_WRITE_DATA;
+    request.address = address;
+    request.data = copy;
+    request.length = length;
+    request.response_queue = NULL;
+
+    if (xQueueSend(Queue_EEPROM_Requests, &request, ticks_to_wait) != pdPASS) {
+        vPortFree(copy);
+        return false;
+    }
+    return true;
+}
+
+uint16_t task_eeprom_crc16(const uint8_t *data, uint16_t length)
+{
+    uint16_t crc = 0xFFFF;
+
+    while (length--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
 /* ============================= Task Init ============================= */
 bool task_eeprom_resources_init(SemaphoreHandle_t *spi_semaphore, cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin)
 {
@@ -217,6 +258,16 @@ bool task_eeprom_resources_init(SemaphoreHandle_t *spi_semaphore, cyhal_spi_t *s
 }
 
 /* ============================= EEPROM Task ============================= */
+/* Helper: Answer a read that could not be done, the requester is waiting */
+static void eeprom_read_failed(eeprom_message_t *request)
+{
+    if (request->command != EEPROM_CMD_READ_DATA || request->response_queue == NULL) {
+        return;
+    }
+    request->length = 0;
+    xQueueSend(request->response_queue, request, portMAX_DELAY);
+}
+
 void task_eeprom(void *arg)
 {
     SemaphoreHandle_t *Semaphore_EEPROM = NULL;
@@ -243,6 +294,7 @@ void task_eeprom(void *arg)
             if (request.data && request.command == EEPROM_CMD_WRITE_DATA) {
                 vPortFree(request.data);
             }
+            eeprom_read_failed(&request);
             continue;
         }
 
@@ -250,7 +302,7 @@ void task_eeprom(void *arg)
         switch (request.command) {
         case EEPROM_CMD_WRITE_DATA:
             if (request.data != NULL) {
-                for (uint8_t i = 0; i < request.length; i++) {
+                for (uint16_t i = 0; i < request.length; i++) {
                     eeprom_write_byte(request.address + i, request.data[i]);
                 }
                 // Free data AFTER the loop
@@ -265,21 +317,20 @@ void task_eeprom(void *arg)
                 if (request.data == NULL) {
                     task_print_error("Failed to allocate memory for EEPROM read");
                     xSemaphoreGive(*Semaphore_EEPROM);
+                    eeprom_read_failed(&request);
                     continue;
                 }
             }
             
             // Read data
-            for (uint8_t i = 0; i < request.length; i++) {
+            for (uint16_t i = 0; i < request.length; i++) {
                 request.data[i] = eeprom_read_byte(request.address + i);
             }
 
-            // Send response if requested
+            // Send response if requested. The queue has room: its owner
+            // sent one request and waits for this answer
             if (request.response_queue != NULL) {
-                if (xQueueSend(request.response_queue, &request, pdMS_TO_TICKS(1000)) != pdPASS) {
-                    task_print_error("Failed to send EEPROM response");
-                    vPortFree(request.data);
-                }
+                xQueueSend(request.response_queue, &request, portMAX_DELAY);
             }
             break;
 
@@ -10,6 +10,8 @@ typedef enum
     EEPROM_CMD_READ_DATA,
 } eeprom_command_t;
 
+/* Every read with a response_queue is answered, even when it fails (length 0
+   in the response), so the queue can be deleted once the answer is in */
 typedef struct
 {
     eeprom_command_t command;
@@ -21,6 +23,25 @@ typedef struct
 
 extern QueueHandle_t Queue_EEPROM_Requests;
 
+/**
+ * @brief Read length bytes into data through the EEPROM task and wait for
+ * the answer, task context only.
+ * @return false if the request could not be queued or the read failed
+ */
+bool task_eeprom_read(uint16_t address, uint8_t *data, uint16_t length);
+
+/**
+ * @brief Queue a copy of data for writing, the EEPROM task frees it.
+ * @param ticks_to_wait How long to wait for room, 0 from the BLE stack
+ * @return false if out of memory or the queue stayed full
+ */
+bool task_eeprom_write(uint16_t address, const uint8_t *data, uint16_t length, TickType_t ticks_to_wait);
+
+/**
+ * @brief CRC-16/CCITT (0x1021, init 0xFFFF) for the records kept in EEPROM.
+ */
+uint16_t task_eeprom_crc16(const uint8_t *data, uint16_t length);
+
 bool task_eeprom_resources_init(SemaphoreHandle_t *spi_semaphore, cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin);
 void task_eeprom(void *arg);
 
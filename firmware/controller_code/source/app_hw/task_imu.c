@@ -5,9 +5,16 @@
 #include "main.h"
 #include "task_console.h"
 #include "FreeRTOS_CLI.h"
-#include "bno055.h"
+#include "imu_backend.h"
+#include "tilt_filter.h"
+#include "attitude_fusion.h"
+#include "flick_detector.h"
+#include "timestamp.h"
+#include "boot_timeline.h"
 #include "semphr.h"
+#include "timers.h"
 #include <string.h>
+#include <stddef.h>
 #include <stdlib.h> // for abs()
 
 /* --- TUNING CONFIGURATION --- */
@@ -21,63 +28,111 @@
 
 #define EEPROM_CALIB_ADDR       0x0000 
 #define CALIB_MAGIC_NUM         0xAB
-#define MOVING_AVG_SIZE         10      /* Smoothing filter size */
+#define CALIB_VERSION           1
+#define EEPROM_TIMEOUT_MS       1000
+/* BNO055 fusion output rate; the LSM6DSM backend paces itself at IMU_FIFO_WAKE_HZ */
+#define IMU_RATE_HZ             100
+#define GESTURE_QUEUE_LEN       8
+/* Tilt samples leave this many slots free so press/release never drop */
+#define GESTURE_QUEUE_RESERVE   2
 
 /* Global State */
-static cyhal_uart_t bno_uart_obj;
+static const imu_backend_t *imu_backend = &IMU_BACKEND_DEFAULT;
+static uint16_t imu_rate_hz = IMU_RATE_HZ;
 static bool imu_initialized = false;
-static imu_data_t latest_imu_data = {0, 0, 0, GESTURE_NONE};
-static imu_calib_t current_calib = {0, 0, 0}; 
-static SemaphoreHandle_t imu_data_mutex = NULL;
+static imu_calib_t current_calib = {0}; 
+
+/*
+ * Latest sample, published with a two-slot seqlock. The IMU task is the only
+ * writer: it fills the slot readers are not using, then bumps imu_seq. A
+ * reader copies slot[seq & 1] and retries if imu_seq moved meanwhile. A
+ * higher priority reader that preempts a half-finished publish still finds
+ * its slot intact, so it never spins waiting on the writer.
+ */
+static imu_data_t imu_slots[2];
+static volatile uint32_t imu_seq = 0;
+
+QueueHandle_t q_gesture_events = NULL;
+static TimerHandle_t repeat_timer = NULL;
 
 /* Logic State */
-static imu_gesture_t locked_gesture = GESTURE_NONE;
+static volatile imu_gesture_t locked_gesture = GESTURE_NONE;
+
+/* Flick State: a flick locks the same gesture the tilt detector would */
+static flick_detector_t flick;
+static volatile bool flick_enabled = true;
+static volatile bool flick_change_flag = false;
+static bool locked_by_flick = false;
+static TickType_t flick_fire_tick = 0;
 
 /* Filter State */
-static int16_t roll_history[MOVING_AVG_SIZE] = {0};
-static int16_t pitch_history[MOVING_AVG_SIZE] = {0};
-static uint8_t history_idx = 0;
-static bool history_filled = false;
+static tilt_filter_t roll_filter;
+static tilt_filter_t pitch_filter;
+static volatile tilt_filter_type_t filter_type = TILT_FILTER_DEFAULT;
+static volatile bool filter_change_flag = false;
 
 static volatile bool calib_req_flag = false;
+static volatile bool tilt_stream_enabled = false;
+
+/* Timing State: written by the IMU task only, reset on request */
+static imu_timing_stats_t timing;
+static volatile bool timing_reset_flag = false;
 
 void task_imu_req_calibration(void) { calib_req_flag = true; }
 
 static BaseType_t cli_handler_imu(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
-static const CLI_Command_Definition_t cmd_imu = {"imu", "\r\nimu <read|calibrate>\r\n", cli_handler_imu, -1};
+static const CLI_Command_Definition_t cmd_imu = {"imu", "\r\nimu <read|calibrate|backend|quat|fusion|timing [reset]|flick [on|off]|filter [none|boxcar|iir|euro|kalman]>\r\n", cli_handler_imu, -1};
 
-/* Helper: Update Moving Average */
+/* Helper: Smooth Roll/Pitch (see tilt_filter.h for the latency/noise of each filter) */
 static void update_filter(int16_t new_roll, int16_t new_pitch, int16_t *avg_roll, int16_t *avg_pitch)
 {
-    if (!history_filled) {
-        for(int i=0; i<MOVING_AVG_SIZE; i++) {
-            roll_history[i] = new_roll;
-            pitch_history[i] = new_pitch;
-        }
-        history_filled = true;
-    } else {
-        roll_history[history_idx] = new_roll;
-        pitch_history[history_idx] = new_pitch;
-        history_idx = (history_idx + 1) % MOVING_AVG_SIZE;
+    if (filter_change_flag) {
+        filter_change_flag = false;
+        tilt_filter_init(&roll_filter, filter_type, imu_rate_hz);
+        tilt_filter_init(&pitch_filter, filter_type, imu_rate_hz);
     }
 
-    int32_t r_sum = 0;
-    int32_t p_sum = 0;
-    for(int i=0; i<MOVING_AVG_SIZE; i++) {
-        r_sum += roll_history[i];
-        p_sum += pitch_history[i];
-    }
-    *avg_roll = (int16_t)(r_sum / MOVING_AVG_SIZE);
-    *avg_pitch = (int16_t)(p_sum / MOVING_AVG_SIZE);
+    *avg_roll = tilt_filter_update(&roll_filter, new_roll);
+    *avg_pitch = tilt_filter_update(&pitch_filter, new_pitch);
 }
 
-/* Helper: Determine Gesture with Hysteresis */
-static imu_gesture_t detect_gesture(int16_t curr_roll, int16_t curr_pitch)
+void task_imu_set_filter(tilt_filter_type_t type)
+{
+    if (type >= TILT_FILTER_COUNT) return;
+    filter_type = type;
+    filter_change_flag = true;
+}
+
+void task_imu_set_flick(bool enable)
+{
+    flick_enabled = enable;
+    flick_change_flag = true;
+}
+
+/*
+ * Helper: Determine Gesture with Hysteresis
+ * curr_* is the filtered tilt, raw_* the unfiltered sample for the flick
+ * detector (filter lag would blunt the velocity it looks for).
+ */
+static imu_gesture_t detect_gesture(int16_t curr_roll, int16_t curr_pitch, int16_t raw_roll, int16_t raw_pitch)
 {
     int16_t delta_r = curr_roll - current_calib.center_roll;
     int16_t delta_p = curr_pitch - current_calib.center_pitch;
     int16_t abs_r = abs(delta_r);
     int16_t abs_p = abs(delta_p);
+    TickType_t now = xTaskGetTickCount();
+    imu_gesture_t flicked = GESTURE_NONE;
+
+    if (flick_change_flag) {
+        flick_change_flag = false;
+        flick_init(&flick, imu_rate_hz);
+    }
+
+    /* Runs every sample so its velocity estimate never goes stale */
+    if (flick_enabled) {
+        flicked = flick_update(&flick, raw_roll - current_calib.center_roll,
+                               raw_pitch - current_calib.center_pitch, now);
+    }
 
     if (locked_gesture == GESTURE_NONE)
     {
@@ -95,6 +150,14 @@ static imu_gesture_t detect_gesture(int16_t curr_roll, int16_t curr_pitch)
                 if (delta_r > 0) locked_gesture = GESTURE_RIGHT;
                 else locked_gesture = GESTURE_LEFT;
             }
+            locked_by_flick = false;
+        }
+        else if (flicked != GESTURE_NONE)
+        {
+            /* Flick onset: press now, the tilt catching up later is the same press */
+            locked_gesture = flicked;
+            locked_by_flick = true;
+            flick_fire_tick = now;
         }
     }
     else
@@ -108,35 +171,275 @@ static imu_gesture_t detect_gesture(int16_t curr_roll, int16_t curr_pitch)
             case GESTURE_RIGHT: if (abs_r < THRESH_RELEASE) release = true; break;
             default: release = true; break;
         }
-        if (release) locked_gesture = GESTURE_NONE;
+        /* A flick fires below the release angle, hold it long enough to count */
+        if (release && locked_by_flick && (now - flick_fire_tick) < pdMS_TO_TICKS(FLICK_MIN_HOLD_MS)) {
+            release = false;
+        }
+        if (release) {
+            /* Lock out flicks so the return stroke or overshoot cannot fire again */
+            if (flick_enabled) flick_lockout(&flick, now);
+            locked_gesture = GESTURE_NONE;
+            locked_by_flick = false;
+        }
     }
     return locked_gesture;
 }
 
-/* Helper: Save Calibration */
-static void save_calibration(int16_t roll, int16_t pitch)
+/* Helper: Queue a gesture transition, never blocks the caller */
+static void publish_gesture_event(gesture_event_type_t type, imu_gesture_t gesture)
 {
+    gesture_event_t evt = { type, gesture, xTaskGetTickCount(), timestamp_us(), 0, 0 };
+    xQueueSendToBack(q_gesture_events, &evt, 0);
+}
+
+void task_imu_set_tilt_stream(bool enable) { tilt_stream_enabled = enable; }
+
+/* 1/16 degree offset to whole degrees, saturated to int8 */
+static int8_t quantize_tilt(int16_t delta)
+{
+    int16_t deg = (delta >= 0) ? (delta + 8) / 16 : (delta - 8) / 16;
+    if (deg > INT8_MAX) return INT8_MAX;
+    if (deg < -INT8_MAX) return -INT8_MAX;
+    return (int8_t)deg;
+}
+
+/* Helper: Analog mode, one sample per IMU update, dropped if the queue is backed up */
+static void publish_tilt_event(int16_t roll, int16_t pitch)
+{
+    gesture_event_t evt = { GESTURE_EVT_TILT, locked_gesture, xTaskGetTickCount(), timestamp_us(),
+                            quantize_tilt(roll - current_calib.center_roll),
+                            quantize_tilt(pitch - current_calib.center_pitch) };
+
+    if (uxQueueSpacesAvailable(q_gesture_events) <= GESTURE_QUEUE_RESERVE) return;
+    xQueueSendToBack(q_gesture_events, &evt, 0);
+}
+
+/* Auto-repeat: fires every GESTURE_REPEAT_MS while a gesture is held */
+static void timer_callback_repeat(TimerHandle_t xTimer)
+{
+    (void)xTimer;
+    imu_gesture_t held = locked_gesture;
+    if (held != GESTURE_NONE) {
+        publish_gesture_event(GESTURE_EVT_REPEAT, held);
+    }
+}
+
+/* Helper: Publish Press/Release edges and start/stop the repeat timer */
+static void update_gesture_events(imu_gesture_t prev, imu_gesture_t curr)
+{
+    if (curr == prev) return;
+
+    if (prev != GESTURE_NONE) {
+        xTimerStop(repeat_timer, 0);
+        publish_gesture_event(GESTURE_EVT_RELEASE, prev);
+    }
+    if (curr != GESTURE_NONE) {
+        static bool first_marked = false;
+
+        publish_gesture_event(GESTURE_EVT_PRESS, curr);
+        xTimerReset(repeat_timer, 0);
+        if (!first_marked) {
+            first_marked = true;
+            boot_mark("imu first gesture");
+        }
+    }
+}
+
+void task_imu_get_timing(imu_timing_stats_t *stats) { *stats = timing; }
+void task_imu_reset_timing(void) { timing_reset_flag = true; }
+
+/* Helper: Period/jitter bookkeeping, t_prev is ignored on the first sample */
+static void update_timing(uint32_t t_prev, uint32_t t_now, uint32_t read_us)
+{
+    uint32_t period, jitter;
+
+    if (timing_reset_flag) {
+        timing_reset_flag = false;
+        memset(&timing, 0, sizeof(timing));
+    }
+    timing.period_us = 1000000u / imu_rate_hz;
+    if (read_us > timing.read_max_us) timing.read_max_us = read_us;
+    if (timing.samples++ == 0) return;
+
+    period = t_now - t_prev;
+    jitter = (period > timing.period_us) ? period - timing.period_us : timing.period_us - period;
+    if (timing.period_min_us == 0 || period < timing.period_min_us) timing.period_min_us = period;
+    if (period > timing.period_max_us) timing.period_max_us = period;
+    if (jitter > timing.jitter_max_us) timing.jitter_max_us = jitter;
+    timing.period_avg_us = (timing.period_avg_us == 0) ? period
+                         : timing.period_avg_us + (((int32_t)period - (int32_t)timing.period_avg_us) >> 4);
+}
+
+/* Helper: Read the saved record through the EEPROM task, false if missing or corrupt */
+static bool load_calibration(imu_calib_t *calib)
+{
+    if (!task_eeprom_read(EEPROM_CALIB_ADDR, (uint8_t *)calib, sizeof(imu_calib_t))) return false;
+
+    return calib->magic_num == CALIB_MAGIC_NUM &&
+           calib->version == CALIB_VERSION &&
+           calib->sensor_len <= IMU_CALIB_BLOB_MAX &&
+           calib->crc == task_eeprom_crc16((const uint8_t *)calib, offsetof(imu_calib_t, crc));
+}
+
+/*
+ * Helper: Save Calibration
+ * The tilt center is always updated. The sensor profile is only replaced once
+ * the sensor reports every axis calibrated, otherwise the one restored at boot
+ * is kept.
+ */
+static void save_calibration(int16_t roll, int16_t pitch, uint8_t calib_stat)
+{
+    uint8_t profile[IMU_CALIB_BLOB_MAX];
+
     current_calib.center_roll = roll;
     current_calib.center_pitch = pitch;
     current_calib.magic_num = CALIB_MAGIC_NUM;
-    
-    // Optional: Send to EEPROM Task here
-    task_print_info("IMU: Calibration Set");
+    current_calib.version = CALIB_VERSION;
+
+    if (imu_backend->read_calib != NULL && imu_backend->calib_len > 0 &&
+        (calib_stat & IMU_CALIB_STAT_SENSORS) == IMU_CALIB_STAT_SENSORS &&
+        imu_backend->read_calib(profile) == CY_RSLT_SUCCESS) {
+        memcpy(current_calib.sensor, profile, imu_backend->calib_len);
+        current_calib.sensor_len = imu_backend->calib_len;
+        current_calib.backend_id = imu_backend->id;
+    }
+    current_calib.crc = task_eeprom_crc16((const uint8_t *)&current_calib, offsetof(imu_calib_t, crc));
+
+    if (task_eeprom_write(EEPROM_CALIB_ADDR, (const uint8_t *)&current_calib, sizeof(current_calib),
+                          pdMS_TO_TICKS(EEPROM_TIMEOUT_MS))) {
+        task_print_info("IMU: Calibration Set (%s)", current_calib.sensor_len ? "center + sensor profile" : "center only");
+    } else {
+        task_print_error("IMU: Calibration Set, EEPROM save failed");
+    }
+}
+
+/* Helper: Publish a sample (IMU task only) */
+static void publish_imu_data(imu_data_t *data)
+{
+    uint32_t next = imu_seq + 1;
+
+    data->seq = next;
+    memcpy(&imu_slots[next & 1], data, sizeof(imu_data_t));
+    __DMB();
+    imu_seq = next;
 }
 
-/* Thread Safe Getter */
+/* Thread Safe Getter: never blocks, never returns a torn sample */
 void task_imu_get_data(imu_data_t *data)
 {
-    if (imu_data_mutex && xSemaphoreTake(imu_data_mutex, pdMS_TO_TICKS(10)) == pdPASS) {
-        *data = latest_imu_data;
-        xSemaphoreGive(imu_data_mutex);
-    }
+    uint32_t seq;
+
+    do {
+        seq = imu_seq;
+        __DMB();
+        memcpy(data, &imu_slots[seq & 1], sizeof(imu_data_t));
+        __DMB();
+    } while (imu_seq != seq);
 }
 
 /* CLI */
+
+/* Helper: Whole-word match of a CLI parameter, so prefixes do not count */
+static bool param_is(const char *param, BaseType_t param_len, const char *word)
+{
+    return param != NULL && (size_t)param_len == strlen(word) && strncmp(param, word, param_len) == 0;
+}
+
 static BaseType_t cli_handler_imu(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString)
 {
-    snprintf(pcWriteBuffer, xWriteBufferLen, "IMU Active\r\n");
+    const char *param;
+    BaseType_t param_len;
+    imu_data_t data;
+
+    param = FreeRTOS_CLIGetParameter(pcCommandString, 1, &param_len);
+    if (param_is(param, param_len, "calibrate")) {
+        task_imu_req_calibration();
+        snprintf(pcWriteBuffer, xWriteBufferLen, "IMU calibration requested\r\n");
+        return pdFALSE;
+    }
+
+    if (param_is(param, param_len, "filter")) {
+        param = FreeRTOS_CLIGetParameter(pcCommandString, 2, &param_len);
+        if (param != NULL) {
+            tilt_filter_type_t type = tilt_filter_from_name(param, param_len);
+            if (type == TILT_FILTER_COUNT) {
+                snprintf(pcWriteBuffer, xWriteBufferLen, "Unknown filter\r\n");
+                return pdFALSE;
+            }
+            task_imu_set_filter(type);
+        }
+        snprintf(pcWriteBuffer, xWriteBufferLen, "IMU filter: %s\r\n", tilt_filter_name(filter_type));
+        return pdFALSE;
+    }
+
+    if (param_is(param, param_len, "timing")) {
+        /* Two lines, the CLI output buffer only holds configCOMMAND_INT_MAX_OUTPUT_SIZE */
+        static bool timing_more = false;
+        imu_timing_stats_t st;
+        param = FreeRTOS_CLIGetParameter(pcCommandString, 2, &param_len);
+        if (param_is(param, param_len, "reset")) {
+            task_imu_reset_timing();
+            snprintf(pcWriteBuffer, xWriteBufferLen, "IMU timing reset\r\n");
+            return pdFALSE;
+        }
+        task_imu_get_timing(&st);
+        if (!timing_more) {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "IMU timing: %lu samples, period %lu us (min %lu avg %lu max %lu)\r\n",
+                     (unsigned long)st.samples, (unsigned long)st.period_us, (unsigned long)st.period_min_us,
+                     (unsigned long)st.period_avg_us, (unsigned long)st.period_max_us);
+            timing_more = true;
+            return pdTRUE;
+        }
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Jitter max %lu us, read max %lu us, overruns %lu\r\n",
+                 (unsigned long)st.jitter_max_us, (unsigned long)st.read_max_us, (unsigned long)st.overruns);
+        timing_more = false;
+        return pdFALSE;
+    }
+
+    if (param_is(param, param_len, "flick")) {
+        param = FreeRTOS_CLIGetParameter(pcCommandString, 2, &param_len);
+        if (param_is(param, param_len, "on")) task_imu_set_flick(true);
+        else if (param_is(param, param_len, "off")) task_imu_set_flick(false);
+        snprintf(pcWriteBuffer, xWriteBufferLen, "IMU flick: %s (%lu fired)\r\n",
+                 flick_enabled ? "on" : "off", (unsigned long)flick.fired);
+        return pdFALSE;
+    }
+
+    if (param_is(param, param_len, "backend")) {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "IMU backend: %s @ %u Hz (%s)\r\n",
+                 imu_backend->name, imu_rate_hz, imu_initialized ? "ok" : "not initialized");
+        return pdFALSE;
+    }
+
+    if (param_is(param, param_len, "quat")) {
+        task_imu_get_data(&data);
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Q w:%d x:%d y:%d z:%d (16384 = 1)\r\n",
+                 data.quat[0], data.quat[1], data.quat[2], data.quat[3]);
+        return pdFALSE;
+    }
+
+    if (param_is(param, param_len, "fusion")) {
+        /* Two lines, the CLI output buffer only holds configCOMMAND_INT_MAX_OUTPUT_SIZE */
+        static bool fusion_more = false;
+        attitude_stats_t st;
+        attitude_get_stats(&st);
+        if (!fusion_more) {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Fusion: %lu updates, accel rejected %lu\r\n",
+                     (unsigned long)st.updates, (unsigned long)st.accel_rejected);
+            fusion_more = true;
+            return pdTRUE;
+        }
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Cycles last %lu avg %lu max %lu, budget %u over %lu\r\n",
+                 (unsigned long)st.cycles_last, (unsigned long)st.cycles_avg, (unsigned long)st.cycles_max,
+                 ATTITUDE_CYCLE_BUDGET, (unsigned long)st.over_budget);
+        fusion_more = false;
+        return pdFALSE;
+    }
+
+    task_imu_get_data(&data);
+    snprintf(pcWriteBuffer, xWriteBufferLen, "H:%d R:%d P:%d G:%d,%d,%d Cal:0x%02X Gest:%d Seq:%lu T:%lu\r\n",
+             data.heading, data.roll, data.pitch, data.gyro_x, data.gyro_y, data.gyro_z,
+             data.calib_stat, data.gesture, (unsigned long)data.seq, (unsigned long)data.timestamp_us);
     return pdFALSE;
 }
 
@@ -145,57 +448,110 @@ void task_imu(void *arg)
 {
     (void)arg;
     cy_rslt_t result;
-    bno055_vec3_t euler_read;
+    imu_sample_t sample;
     int16_t avg_roll = 0, avg_pitch = 0;
+    imu_gesture_t prev_gesture, gesture;
+    imu_data_t data;
+    TickType_t last_wake;
+    uint32_t t_sample, t_prev = 0;
+    uint8_t calib_stat = 0;
+    bool first_sample_marked = false;
+    const uint8_t *restore = NULL;
+
+    boot_mark("imu task");
 
-    imu_data_mutex = xSemaphoreCreateMutex();
-    
-    /* Hardware Reset & Init */
-    cyhal_gpio_write(MOD_1_PIN_IO_IMU_nRESET, false);
-    vTaskDelay(pdMS_TO_TICKS(10));
-    cyhal_gpio_write(MOD_1_PIN_IO_IMU_nRESET, true);
-    vTaskDelay(pdMS_TO_TICKS(800));
-    
-    const cyhal_uart_cfg_t uart_config = {
-        .data_bits = 8, .stop_bits = 1, .parity = CYHAL_UART_PARITY_NONE, .rx_buffer = NULL, .rx_buffer_size = 0
-    };
-    cyhal_uart_init(&bno_uart_obj, MOD_1_PIN_UART_IMU_TX, MOD_1_PIN_UART_IMU_RX, NC, NC, NULL, &uart_config);
-    uint32_t baud;
-    cyhal_uart_set_baud(&bno_uart_obj, 115200, &baud);
-    
-    if (bno055_init(&bno_uart_obj) == CY_RSLT_SUCCESS) {
+    /* Saved center and sensor profile, so gestures work without recalibrating */
+    if (load_calibration(&current_calib)) {
+        if (current_calib.sensor_len > 0 && current_calib.sensor_len == imu_backend->calib_len &&
+            current_calib.backend_id == imu_backend->id) {
+            restore = current_calib.sensor;
+        }
+        task_print_info("IMU: Calibration loaded (center %d,%d%s)", current_calib.center_roll,
+                        current_calib.center_pitch, restore ? ", sensor profile" : "");
+    } else {
+        memset(&current_calib, 0, sizeof(current_calib));
+        task_print_info("IMU: No saved calibration");
+    }
+
+    boot_mark("imu calib loaded");
+
+    if (imu_backend->init(restore) == CY_RSLT_SUCCESS &&
+        imu_backend->set_rate(IMU_RATE_HZ, &imu_rate_hz) == CY_RSLT_SUCCESS) {
         imu_initialized = true;
-        task_print_info("BNO055: Initialized (Tilt Mode)");
+        boot_mark("imu sensor ready");
+        task_print_info("IMU: %s initialized (Tilt Mode, %u Hz)", imu_backend->name, imu_rate_hz);
     } else {
-        task_print_error("BNO055: Init Failed");
+        task_print_error("IMU: %s init failed", imu_backend->name);
     }
 
+    tilt_filter_init(&roll_filter, filter_type, imu_rate_hz);
+    tilt_filter_init(&pitch_filter, filter_type, imu_rate_hz);
+    flick_init(&flick, imu_rate_hz);
+
+    /*
+     * Polled backends run on a fixed grid from vTaskDelayUntil, so read time
+     * and preemption do not stretch the period. Backends with a data-ready
+     * hook are paced by the sensor clock instead.
+     */
+    last_wake = xTaskGetTickCount();
     while (1) {
+        if (imu_initialized && imu_backend->wait_data_ready != NULL) {
+            imu_backend->wait_data_ready(2 * 1000 / imu_rate_hz);
+        } else if (xTaskDelayUntil(&last_wake, pdMS_TO_TICKS(1000 / imu_rate_hz)) == pdFALSE) {
+            timing.overruns++;
+        }
+        t_sample = timestamp_us();
+
         if (imu_initialized) {
-            result = bno055_read_euler(&euler_read);
+            result = imu_backend->read_sample(&sample);
+            update_timing(t_prev, t_sample, timestamp_us() - t_sample);
+            t_prev = t_sample;
 
             if (calib_req_flag) {
                 calib_req_flag = false;
-                save_calibration(avg_roll, avg_pitch);
+                save_calibration(avg_roll, avg_pitch, calib_stat);
+                /* Reading the profile stalls the sensor, restart the grid rather than catch up */
+                last_wake = xTaskGetTickCount();
             }
             
             if (result == CY_RSLT_SUCCESS) {
-                update_filter(euler_read.y, euler_read.z, &avg_roll, &avg_pitch);
-
-                if (xSemaphoreTake(imu_data_mutex, pdMS_TO_TICKS(10)) == pdPASS) {
-                    latest_imu_data.heading = euler_read.x;
-                    latest_imu_data.roll    = avg_roll;
-                    latest_imu_data.pitch   = avg_pitch;
-                    latest_imu_data.gesture = detect_gesture(avg_roll, avg_pitch);
-                    xSemaphoreGive(imu_data_mutex);
+                calib_stat = sample.calib_stat;
+                update_filter(sample.roll, sample.pitch, &avg_roll, &avg_pitch);
+
+                prev_gesture = locked_gesture;
+                gesture = detect_gesture(avg_roll, avg_pitch, sample.roll, sample.pitch);
+                update_gesture_events(prev_gesture, gesture);
+                if (tilt_stream_enabled) publish_tilt_event(avg_roll, avg_pitch);
+
+                data.heading = sample.heading;
+                data.roll    = avg_roll;
+                data.pitch   = avg_pitch;
+                data.gyro_x  = sample.gyro_x;
+                data.gyro_y  = sample.gyro_y;
+                data.gyro_z  = sample.gyro_z;
+                memcpy(data.quat, sample.quat, sizeof(data.quat));
+                data.calib_stat = sample.calib_stat;
+                data.gesture = gesture;
+                data.timestamp_us = t_sample;
+                publish_imu_data(&data);
+
+                /* Latched, boot_mark() searches the stage table */
+                if (!first_sample_marked) {
+                    first_sample_marked = true;
+                    boot_mark("imu first sample");
+                    task_print_info("IMU: Gesture-ready %lu ms after boot", (unsigned long)(t_sample / 1000));
                 }
             }
         }
-        vTaskDelay(pdMS_TO_TICKS(20)); // 50Hz
     }
 }
 
 bool task_imu_resources_init(void) {
+    q_gesture_events = xQueueCreate(GESTURE_QUEUE_LEN, sizeof(gesture_event_t));
+    repeat_timer = xTimerCreate("Gesture Repeat", pdMS_TO_TICKS(GESTURE_REPEAT_MS), pdTRUE, NULL, timer_callback_repeat);
+    if (q_gesture_events == NULL || repeat_timer == NULL) return false;
+
     FreeRTOS_CLIRegisterCommand(&cmd_imu);
-    return (xTaskCreate(task_imu, "IMU", 10*configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
-}
\ No newline at end of file
+    /* Above everything but the BLE task so the sample grid holds under load */
+    return (xTaskCreate(task_imu, "IMU", 10*configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 3, NULL) == pdPASS);
+}
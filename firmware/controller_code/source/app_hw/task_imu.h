@@ -2,6 +2,8 @@
 #define __TASK_IMU_H__
 
 #include "main.h"
+#include "tilt_filter.h"
+#include "imu_backend.h"
 
 /* Gesture Definitions - Explicit Values */
 typedef enum {
@@ -17,16 +19,65 @@ typedef struct {
     int16_t heading;
     int16_t roll;
     int16_t pitch;
+    int16_t gyro_x;         /* 16 LSB = 1 dps */
+    int16_t gyro_y;
+    int16_t gyro_z;
+    int16_t quat[4];        /* Attitude w, x, y, z, 2^14 LSB = 1 */
+    uint8_t calib_stat;     /* BNO055 CALIB_STAT register */
     imu_gesture_t gesture;
+    uint32_t seq;           /* Increments once per published sample */
+    uint32_t timestamp_us;  /* When the sample was taken, see timestamp.h */
 } imu_data_t;
 
-/* Calibration Structure to save in EEPROM */
+/* Sample timing, from the 1 MHz timestamps of consecutive samples */
 typedef struct {
+    uint32_t samples;
+    uint32_t period_us;     /* Nominal, 1e6 / rate */
+    uint32_t period_min_us;
+    uint32_t period_max_us;
+    uint32_t period_avg_us; /* Running average, 1/16 weight */
+    uint32_t jitter_max_us; /* Worst |period - nominal| */
+    uint32_t read_max_us;   /* Longest backend read */
+    uint32_t overruns;      /* Periods the loop started late (deadline already passed) */
+} imu_timing_stats_t;
+
+/* Gesture transitions published to the BLE task */
+typedef enum {
+    GESTURE_EVT_PRESS = 0,  /* Tilt crossed the trigger threshold */
+    GESTURE_EVT_RELEASE,    /* Tilt returned inside the release threshold */
+    GESTURE_EVT_REPEAT,     /* Auto-repeat tick while the gesture is held */
+    GESTURE_EVT_TILT        /* Analog sample, only while the tilt stream is on */
+} gesture_event_type_t;
+
+typedef struct {
+    gesture_event_type_t type;
+    imu_gesture_t gesture;
+    TickType_t tick;        /* When the transition was detected */
+    uint32_t timestamp_us;  /* Same, from timestamp_us() */
+    int8_t tilt_roll;       /* GESTURE_EVT_TILT: degrees from calibrated center */
+    int8_t tilt_pitch;
+} gesture_event_t;
+
+/* Auto-repeat period while a gesture is held (approx 3.6 moves per second) */
+#define GESTURE_REPEAT_MS       275
+
+/* Task Resources */
+extern QueueHandle_t q_gesture_events;
+
+/* Calibration Structure to save in EEPROM */
+typedef struct __attribute__((packed)) {
+    uint8_t magic_num;          /* CALIB_MAGIC_NUM */
+    uint8_t version;            /* CALIB_VERSION, bumped when this layout changes */
+    uint8_t backend_id;         /* IMU_BACKEND_ID_x the sensor profile belongs to */
+    uint8_t sensor_len;         /* Valid bytes in sensor[], 0 = tilt center only */
     int16_t center_roll;
     int16_t center_pitch;
-    uint8_t magic_num; 
+    uint8_t sensor[IMU_CALIB_BLOB_MAX];
+    uint16_t crc;               /* CRC-16/CCITT of everything above */
 } imu_calib_t;
 
+/* Copy the latest sample. Wait-free for readers; compare seq between calls
+   to detect missed samples */
 void task_imu_get_data(imu_data_t *data);
 bool task_imu_resources_init(void);
 void task_imu(void *arg);
@@ -34,4 +85,17 @@ void task_imu(void *arg);
 /* Function to trigger calibration from Bluetooth Task */
 void task_imu_req_calibration(void);
 
-#endif /* __TASK_IMU_H__ */
\ No newline at end of file
+/* Select the roll/pitch smoothing filter, applied on the next sample */
+void task_imu_set_filter(tilt_filter_type_t type);
+
+/* Enable/disable the gyro-rate flick detector (on by default) */
+void task_imu_set_flick(bool enable);
+
+/* Also publish a GESTURE_EVT_TILT for every sample (analog mode) */
+void task_imu_set_tilt_stream(bool enable);
+
+/* Copy / clear the sample timing counters */
+void task_imu_get_timing(imu_timing_stats_t *stats);
+void task_imu_reset_timing(void);
+
+#endif /* __TASK_IMU_H__ */
@@ -0,0 +1,157 @@
+#include "tilt_filter.h"
+#include <string.h>
+#include <math.h>
+
+static const char *const filter_names[TILT_FILTER_COUNT] = {
+    [TILT_FILTER_NONE]   = "none",
+    [TILT_FILTER_BOXCAR] = "boxcar",
+    [TILT_FILTER_IIR]    = "iir",
+    [TILT_FILTER_EURO]   = "euro",
+    [TILT_FILTER_KALMAN] = "kalman",
+};
+
+static int16_t clamp_i16(float v)
+{
+    if (v > INT16_MAX) return INT16_MAX;
+    if (v < INT16_MIN) return INT16_MIN;
+    return (int16_t)lroundf(v);
+}
+
+/* Smoothing factor of a first-order low pass with the given cutoff */
+static float euro_alpha(float cutoff_hz, float dt)
+{
+    float tau = 1.0f / (2.0f * (float)M_PI * cutoff_hz);
+    return 1.0f / (1.0f + tau / dt);
+}
+
+static void filter_prime(tilt_filter_t *f, int16_t x)
+{
+    switch (f->type) {
+        case TILT_FILTER_BOXCAR:
+            for (int i = 0; i < TILT_BOXCAR_SIZE; i++) {
+                f->boxcar.history[i] = x;
+            }
+            f->boxcar.sum = (int32_t)x * TILT_BOXCAR_SIZE;
+            f->boxcar.idx = 0;
+            break;
+
+        case TILT_FILTER_IIR:
+            f->iir.y_q15 = (int32_t)x << 15;
+            break;
+
+        case TILT_FILTER_EURO:
+            f->euro.x = x;
+            f->euro.dx = 0.0f;
+            f->euro.x_prev = x;
+            break;
+
+        case TILT_FILTER_KALMAN:
+            f->kalman.angle = x;
+            f->kalman.rate = 0.0f;
+            f->kalman.p[0][0] = TILT_KALMAN_R_MEAS;
+            f->kalman.p[0][1] = 0.0f;
+            f->kalman.p[1][0] = 0.0f;
+            f->kalman.p[1][1] = TILT_KALMAN_R_MEAS / (f->dt * f->dt);
+            break;
+
+        default:
+            break;
+    }
+    f->primed = true;
+}
+
+void tilt_filter_init(tilt_filter_t *f, tilt_filter_type_t type, uint16_t rate_hz)
+{
+    memset(f, 0, sizeof(*f));
+    f->type = (type < TILT_FILTER_COUNT) ? type : TILT_FILTER_NONE;
+    f->dt = 1.0f / (float)(rate_hz ? rate_hz : 1);
+    f->primed = false;
+}
+
+int16_t tilt_filter_update(tilt_filter_t *f, int16_t x)
+{
+    if (!f->primed) {
+        filter_prime(f, x);
+        return x;
+    }
+
+    switch (f->type) {
+        case TILT_FILTER_BOXCAR:
+        {
+            /* Running sum: drop the oldest sample, add the newest */
+            f->boxcar.sum += x - f->boxcar.history[f->boxcar.idx];
+            f->boxcar.history[f->boxcar.idx] = x;
+            f->boxcar.idx = (f->boxcar.idx + 1) % TILT_BOXCAR_SIZE;
+            return (int16_t)(f->boxcar.sum / TILT_BOXCAR_SIZE);
+        }
+
+        case TILT_FILTER_IIR:
+        {
+            /* y += alpha * (x - y), all in Q15 */
+            int32_t err = ((int32_t)x << 15) - f->iir.y_q15;
+            f->iir.y_q15 += (int32_t)(((int64_t)err * TILT_IIR_ALPHA_Q15) >> 15);
+            return (int16_t)((f->iir.y_q15 + (1 << 14)) >> 15);
+        }
+
+        case TILT_FILTER_EURO:
+        {
+            /* Cutoff rises with speed: smooth at rest, low lag while tilting */
+            float raw_dx = ((float)x - f->euro.x_prev) / f->dt;
+            f->euro.x_prev = x;
+            f->euro.dx += euro_alpha(TILT_EURO_D_CUTOFF_HZ, f->dt) * (raw_dx - f->euro.dx);
+
+            float cutoff = TILT_EURO_MIN_CUTOFF_HZ + TILT_EURO_BETA * fabsf(f->euro.dx);
+            f->euro.x += euro_alpha(cutoff, f->dt) * ((float)x - f->euro.x);
+            return clamp_i16(f->euro.x);
+        }
+
+        case TILT_FILTER_KALMAN:
+        {
+            /* Constant-rate model, state = [angle, rate], measurement = angle */
+            float dt = f->dt;
+            float (*p)[2] = f->kalman.p;
+            float q = TILT_KALMAN_Q_ACCEL;
+
+            /* Predict */
+            f->kalman.angle += f->kalman.rate * dt;
+            p[0][0] += dt * (p[1][0] + p[0][1] + dt * p[1][1]) + q * dt * dt * dt * dt / 4.0f;
+            p[0][1] += dt * p[1][1] + q * dt * dt * dt / 2.0f;
+            p[1][0] += dt * p[1][1] + q * dt * dt * dt / 2.0f;
+            p[1][1] += q * dt * dt;
+
+            /* Update */
+            float s = p[0][0] + TILT_KALMAN_R_MEAS;
+            float k0 = p[0][0] / s;
+            float k1 = p[1][0] / s;
+            float innov = (float)x - f->kalman.angle;
+
+            f->kalman.angle += k0 * innov;
+            f->kalman.rate  += k1 * innov;
+
+            float p00 = p[0][0], p01 = p[0][1];
+            p[0][0] -= k0 * p00;
+            p[0][1] -= k0 * p01;
+            p[1][0] -= k1 * p00;
+            p[1][1] -= k1 * p01;
+            return clamp_i16(f->kalman.angle);
+        }
+
+        default:
+            return x;
+    }
+}
+
+const char *tilt_filter_name(tilt_filter_type_t type)
+{
+    return (type < TILT_FILTER_COUNT) ? filter_names[type] : NULL;
+}
+
+tilt_filter_type_t tilt_filter_from_name(const char *name, size_t len)
+{
+    for (int i = 0; i < TILT_FILTER_COUNT; i++) {
+        if (strlen(filter_names[i]) == len && strncmp(filter_names[i], name, len) == 0) {
+            return (tilt_filter_type_t)i;
+        }
+    }
+    return TILT_FILTER_COUNT;
+}
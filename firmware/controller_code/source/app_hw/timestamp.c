@@ -0,0 +1,49 @@
+#include "timestamp.h"
+
+/* Loaded as the start value to tell a 32-bit counter from a 16-bit one */
+#define TIMESTAMP_WIDTH_PROBE   0x10000u
+
+static cyhal_timer_t timestamp_timer;
+static bool timestamp_ready = false;
+
+cy_rslt_t timestamp_init(void)
+{
+    cy_rslt_t rslt;
+    cyhal_timer_cfg_t timer_cfg = {
+        .compare_value = 0,
+        .period = 0xFFFFFFFFu,
+        .direction = CYHAL_TIMER_DIR_UP,
+        .is_compare = false,
+        .is_continuous = true,
+        .value = TIMESTAMP_WIDTH_PROBE
+    };
+
+    if (timestamp_ready) return CY_RSLT_SUCCESS;
+
+    rslt = cyhal_timer_init(&timestamp_timer, NC, NULL);
+    if (rslt != CY_RSLT_SUCCESS) return rslt;
+
+    /* The HAL hands out whichever TCPWM is free, and a 16-bit one would
+       wrap every 65 ms. It cannot hold the probe value, so refuse it */
+    rslt = cyhal_timer_configure(&timestamp_timer, &timer_cfg);
+    if (rslt == CY_RSLT_SUCCESS && cyhal_timer_read(&timestamp_timer) != TIMESTAMP_WIDTH_PROBE) {
+        rslt = CY_RSLT_TYPE_ERROR;
+    }
+
+    timer_cfg.value = 0;
+    if (rslt == CY_RSLT_SUCCESS) rslt = cyhal_timer_configure(&timestamp_timer, &timer_cfg);
+    if (rslt == CY_RSLT_SUCCESS) rslt = cyhal_timer_set_frequency(&timestamp_timer, TIMESTAMP_FREQ_HZ);
+    if (rslt == CY_RSLT_SUCCESS) rslt = cyhal_timer_start(&timestamp_timer);
+    if (rslt != CY_RSLT_SUCCESS) {
+        cyhal_timer_free(&timestamp_timer);
+        return rslt;
+    }
+
+    timestamp_ready = true;
+    return CY_RSLT_SUCCESS;
+}
+
+uint32_t timestamp_us(void)
+{
+    return timestamp_ready ? cyhal_timer_read(&timestamp_timer) : 0;
+}
@@ -15,6 +15,15 @@ BOUNCE_COOLDOWN = 300
 RUMBLE_COOLDOWN = 2000  # Minimum time between rumble signals (ms)
 SMOOTH_MOVE_DURATION = 12
 
+# Analog tilt: the player rolls one cell at a time towards the controller's
+# tilt, faster the further it is tilted, instead of jumping on gestures.
+# Gestures still drive the win screen.
+ANALOG_TILT = False
+TILT_DEADZONE = 8        # Degrees from center that do nothing
+TILT_FULL = 40           # Degrees for the fastest roll
+TILT_SLOW_FRAMES = 36    # Frames per cell just past the deadzone
+TILT_FAST_FRAMES = 8     # Frames per cell at TILT_FULL and beyond
+
 # UI element heights
 TOP_UI_HEIGHT = 3
 BOTTOM_UI_HEIGHT = 30
@@ -115,12 +124,13 @@ class Player:
         self.move_queue = []
         self.path = []
         self.total_distance = 0
+        self.frames_per_cell = SMOOTH_MOVE_DURATION
         self.is_moving = False
         self.will_hit_wall = False
         self.wall_direction = None
         self.ignore_commands = 0
     
-    def queue_moves(self, dx, dy, count):
+    def queue_moves(self, dx, dy, count, frames_per_cell=SMOOTH_MOVE_DURATION):
         """Queue multiple moves and calculate the complete path"""
         temp_x = self.x
         temp_y = self.y
@@ -146,6 +156,7 @@ class Player:
             self.target_x = new_path[-1][0]
             self.target_y = new_path[-1][1]
             self.total_distance = len(new_path) - 1
+            self.frames_per_cell = frames_per_cell
             self.move_progress = 0
             self.is_moving = True
             self.will_hit_wall = hit_wall
@@ -178,7 +189,7 @@ class Player:
         if self.is_moving and self.path:
             self.move_progress += 1
             
-            total_frames = self.total_distance * SMOOTH_MOVE_DURATION
+            total_frames = self.total_distance * self.frames_per_cell
             
             if self.move_progress < total_frames:
                 t = self.move_progress / total_frames
@@ -385,6 +396,22 @@ def draw_realistic_player(screen, x, y, frame_count, trail, offset_x, offset_y):
         highlight_size = max(spec_size // 3, 1)
         pygame.draw.circle(screen, (255, 255, 255), (spec_x, spec_y), highlight_size)
 
+def tilt_move():
+    """
+    Direction and frames per cell for the current analog tilt, the larger
+    axis wins. Returns None inside the deadzone.
+    """
+    x, y = uart.get_tilt()
+    if max(abs(x), abs(y)) < TILT_DEADZONE:
+        return None
+    if abs(x) >= abs(y):
+        dx, dy, amount = (1 if x > 0 else -1), 0, abs(x)
+    else:
+        dx, dy, amount = 0, (1 if y > 0 else -1), abs(y)
+    t = min(1.0, (amount - TILT_DEADZONE) / (TILT_FULL - TILT_DEADZONE))
+    frames = int(round(TILT_SLOW_FRAMES + (TILT_FAST_FRAMES - TILT_SLOW_FRAMES) * t))
+    return dx, dy, frames
+
 def score_calculation(timer, prev_high_score):
     if prev_high_score == 0:
         new_high_score = timer
@@ -408,6 +435,8 @@ def handle_win_gesture(win_gesture_type, win_gesture_count, gesture_type):
 
 def game_loop(screen, clock, high_score):
     uart.start_polling()
+    if ANALOG_TILT:
+        uart.set_analog(True)
     
     player = Player(1, 1)
     font = pygame.font.Font(None, 32)
@@ -540,7 +569,7 @@ def game_loop(screen, clock, high_score):
                         win_gesture_type = None
                 
                 # Handle movement commands during gameplay
-                elif not player.is_moving and not won:
+                elif not player.is_moving and not won and not ANALOG_TILT:
                     if player.should_ignore():
                         pass
                     if command == "UP":
@@ -552,6 +581,13 @@ def game_loop(screen, clock, high_score):
                     elif command == "RIGHT":
                         player.queue_moves(1, 0, value)
             
+            # Analog tilt rolls the player whenever it is not already moving
+            if ANALOG_TILT and not player.is_moving and not won:
+                move = tilt_move()
+                if move:
+                    dx, dy, frames = move
+                    player.queue_moves(dx, dy, 1, frames)
+            
             # Update player position and check for win
             if player.update_position() and not won:
                 won = True
@@ -653,4 +689,6 @@ def game_loop(screen, clock, high_score):
             clock.tick(FPS)
     
     finally:
+        if ANALOG_TILT:
+            uart.set_analog(False)
         uart.stop_polling()
\ No newline at end of file
@@ -11,6 +11,11 @@ def send_event(event_code : str):
 # Thread-safe queue for incoming commands
 command_queue = queue.Queue()
 
+# Latest analog tilt (x, y) in degrees, +x = RIGHT, +y = DOWN.
+# Fed by "A <x> <y>" frames while analog mode is on, never queued as commands.
+_tilt = (0, 0)
+_tilt_lock = threading.Lock()
+
 # Flag to control the polling thread
 _running = False
 _poll_thread = None
@@ -33,11 +38,38 @@ def _uart_poll_loop():
                     line, buffer = buffer.split('\n', 1)
                     line = line.strip()
                     
-                    if line:  # Only process non-empty lines
+                    if line.startswith('A '):
+                        _store_tilt(line)
+                    elif line:  # Only process non-empty lines
                         command_queue.put(line.upper())
         except Exception as e:
             print(f"UART polling error: {e}")
 
+def _store_tilt(line):
+    """Parse an "A <x> <y>" frame into the latest tilt, ignore malformed ones"""
+    global _tilt
+    parts = line.split()
+    if len(parts) != 3:
+        return
+    try:
+        tilt = (int(parts[1]), int(parts[2]))
+    except ValueError:
+        return
+    with _tilt_lock:
+        _tilt = tilt
+
+def set_analog(enable : bool):
+    """Ask the console for analog tilt frames (kept across controller reconnects)"""
+    send_event('ANALOG 1' if enable else 'ANALOG 0')
+
+def get_tilt():
+    """
+    Latest analog tilt as (x, y) degrees from center, +x = RIGHT, +y = DOWN.
+    Stays (0, 0) until analog mode is on and the controller starts streaming.
+    """
+    with _tilt_lock:
+        return _tilt
+
 def start_polling():
     """Start the UART polling thread"""
     global _running, _poll_thread